@@ -19,12 +19,12 @@ extern "C" {
 
 namespace AV::Utils {
 
-AsyncNDISourceResult AsyncNDISource::Create(const std::string &source_name, const AVRational &frame_rate) {
+AsyncNDISourceResult AsyncNDISource::Create(const std::string &source_name, const AVRational &frame_rate, bool async_video) {
     FUNCTION_CALL_DEBUG();
     AvException err;
 
     try {
-        return {std::shared_ptr<AsyncNDISource>(new AsyncNDISource(source_name, frame_rate)), AvError::NOERROR};
+        return {std::shared_ptr<AsyncNDISource>(new AsyncNDISource(source_name, frame_rate, async_video)), AvError::NOERROR};
     } catch(const AvException e) {
         err = e;
         DEBUG("Error creating NDI source: %s", e.what());
@@ -33,35 +33,21 @@ AsyncNDISourceResult AsyncNDISource::Create(const std::string &source_name, cons
     return {nullptr, err};
 }
 
-AvException AsyncNDISource::SendFrame(const AVFrame *frame) {
+AvException AsyncNDISource::SendFrame(FramePtr &&frame) {
     FUNCTION_CALL_DEBUG();
 
-    // Clone frame
-    AVFrame *frame_copy = av_frame_clone(frame);
-    if(frame_copy == nullptr) {
-        return AvError::FRAMEALLOC;
-    }
+    auto &queue = (frame->width != 0 && frame->height != 0) ? _video_queue : _audio_queue;
 
-    // Sleep until ready to send frame
-    _frame_queue_mutex.lock();
-    auto size = _frame_queue.size();
-    _frame_queue_mutex.unlock();
-    while(size >= FRAME_QUEUE_SIZE) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));
-        _frame_queue_mutex.lock();
-        size = _frame_queue.size();
-        _frame_queue_mutex.unlock();
+    // Sleeps until the sender thread frees up a slot
+    DEBUG("Frame Queue Size: %ld", queue.Size());
+    if(!queue.Push(frame)) {
+        return AvError::BUFFERFULL;
     }
 
-    _frame_queue_mutex.lock();
-    DEBUG("Frame Queue Size: %ld", _frame_queue.size());
-    _frame_queue.push_back(frame_copy);
-    _frame_queue_mutex.unlock();
-
     return AvError::NOERROR;
 }
 
-AsyncNDISource::AsyncNDISource(const std::string &source_name, const AVRational &frame_rate) : _source_name(source_name), _frame_rate(frame_rate) {
+AsyncNDISource::AsyncNDISource(const std::string &source_name, const AVRational &frame_rate, bool async_video) : _source_name(source_name), _frame_rate(frame_rate), _async_video(async_video) {
     FUNCTION_CALL_DEBUG();
 
     AvError err = _Initialize();
@@ -73,11 +59,22 @@ AsyncNDISource::AsyncNDISource(const std::string &source_name, const AVRational
 AsyncNDISource::~AsyncNDISource() {
     FUNCTION_CALL_DEBUG();
 
-    _running = false;
-    if(_frame_sender_thread.joinable()) {
-        _frame_sender_thread.join();
+    // The sender threads drain what is left before they exit
+    _video_queue.Close();
+    _audio_queue.Close();
+    if(_video_sender_thread.joinable()) {
+        _video_sender_thread.join();
+    }
+
+    if(_audio_sender_thread.joinable()) {
+        _audio_sender_thread.join();
     }
 
+#ifdef _DEBUG
+    NV12PackStats nv12_stats = _nv12_packer.GetStats();
+    DEBUG("NV12 frames sent zero copy: %lu | packed: %lu", nv12_stats.zero_copy_frames, nv12_stats.packed_frames);
+#endif
+
     if(_ndi_send_instance != nullptr) {
         NDIlib_send_destroy(_ndi_send_instance);
     }
@@ -96,37 +93,72 @@ AvError AsyncNDISource::_Initialize() {
         return AvError::NDISENDINSTANCE;
     }
 
-    _frame_sender_thread = std::thread(&AsyncNDISource::_Thread_FrameSender, this);
+    // Audio may run this far ahead of the video frame being sent
+    if(_frame_rate.num > 0 && _frame_rate.den > 0) {
+        _video_frame_duration_us = av_rescale(1000000, _frame_rate.den, _frame_rate.num);
+    }
+
+    _video_sender_thread = std::thread(&AsyncNDISource::_Thread_VideoSender, this);
+    _audio_sender_thread = std::thread(&AsyncNDISource::_Thread_AudioSender, this);
 
     return AvError::NOERROR;
 }
 
-void AsyncNDISource::_Thread_FrameSender() {
+void AsyncNDISource::_Thread_VideoSender() {
     FUNCTION_CALL_DEBUG();
 
-    while(_running || [this]{ std::unique_lock<std::mutex> lock(_frame_queue_mutex); return !_frame_queue.empty(); }()) {
-        std::unique_lock<std::mutex> lock(_frame_queue_mutex);
-        if(!_frame_queue.empty()) {
-            AVFrame *frame = _frame_queue.front();
-            _frame_queue.pop_front();
-            lock.unlock();
-
-            if(frame->width != 0 && frame->height != 0) {
-                _SendVideoFrame(frame);
-            } else {
-                _SendAudioFrame(frame);
+    FramePtr frame;
+    while(true) {
+        if(!_video_queue.TryPop(frame)) {
+            // Nothing to pace audio against, let it through until video shows up again
+            _SetVideoClock(INT64_MAX);
+            if(!_video_queue.Pop(frame)) {
+                break;
             }
+        }
+
+        if(frame->pts != AV_NOPTS_VALUE) {
+            _SetVideoClock(av_rescale_q(frame->pts, frame->time_base, {1, 1000000}));
+        }
+
+        // Blocks for a frame period, NDI clocks the video
+        _SendVideoFrame(std::move(frame));
+    }
+
+    // Wait for the SDK to let go of the last frame before it is freed
+    _FlushVideo();
+
+    _SetVideoClock(INT64_MAX);
+}
 
-            av_frame_free(&frame);
-        } else {
-            lock.unlock();
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+void AsyncNDISource::_Thread_AudioSender() {
+    FUNCTION_CALL_DEBUG();
+
+    FramePtr frame;
+    while(_audio_queue.Pop(frame)) {
+        // Hold audio until the video it belongs to is on the wire
+        if(frame->pts != AV_NOPTS_VALUE) {
+            int64_t pts_us = av_rescale_q(frame->pts, frame->time_base, {1, 1000000});
+            int64_t clock_us = _video_clock_us.load(std::memory_order_acquire);
+
+            while(clock_us != INT64_MAX && pts_us > clock_us + _video_frame_duration_us) {
+                _video_clock_us.wait(clock_us, std::memory_order_acquire);
+                clock_us = _video_clock_us.load(std::memory_order_acquire);
+            }
         }
+
+        _SendAudioFrame(frame.get());
+        frame.reset();
     }
-    
 }
 
-AvError AsyncNDISource::_SendVideoFrame(const AVFrame *frame) {
+void AsyncNDISource::_SetVideoClock(int64_t pts_us) {
+    if(_video_clock_us.exchange(pts_us, std::memory_order_acq_rel) != pts_us) {
+        _video_clock_us.notify_all();
+    }
+}
+
+AvError AsyncNDISource::_SendVideoFrame(FramePtr &&owned_frame) {
     FUNCTION_CALL_DEBUG();
 
 #ifdef _DEBUG
@@ -135,7 +167,10 @@ AvError AsyncNDISource::_SendVideoFrame(const AVFrame *frame) {
 #endif
 
 
-    bool manual_free = false;
+    const AVFrame *frame = owned_frame.get();
+
+    // Pool buffer backing the frame when NV12 planes had to be packed
+    AVBufferRef *packed_buffer = nullptr;
 
     // Build NDI packet from frame
     NDIlib_video_frame_v2_t video_frame;
@@ -170,8 +205,10 @@ AvError AsyncNDISource::_SendVideoFrame(const AVFrame *frame) {
         DEBUG("data[1]: %p", frame->data[1]);
         DEBUG("data[1] - data[0]: %ld | Frame 0 Size: %d", frame->data[1] - frame->data[0], frame->linesize[0] * frame->height);
 
-        video_frame.p_data = CombinePlanesNV12(frame, 2);
-        manual_free = true;
+        video_frame.p_data = _nv12_packer.Pack(frame, &packed_buffer);
+        if(video_frame.p_data == nullptr) {
+            return AvError::AVMALLOC;
+        }
 
         break;
     default:
@@ -182,14 +219,21 @@ AvError AsyncNDISource::_SendVideoFrame(const AVFrame *frame) {
     video_frame.yres = frame->height;
     video_frame.frame_rate_N = _frame_rate.num;
     video_frame.frame_rate_D = _frame_rate.den;
-    video_frame.timecode = NDIlib_send_timecode_synthesize;
+    video_frame.timecode = _timecode.Timecode(frame);
     video_frame.frame_format_type = NDIlib_frame_format_type_progressive;
 
-    // Send the frame
-    NDIlib_send_send_video_v2(_ndi_send_instance, &video_frame);
+    if(_async_video) {
+        // Returns once the frame is queued, the SDK is then done with the previous one
+        NDIlib_send_send_video_async_v2(_ndi_send_instance, &video_frame);
+
+        av_buffer_unref(&_inflight_buffer);
+        _inflight_buffer = packed_buffer;
+        _inflight_frame = std::move(owned_frame);
+    } else {
+        // Send the frame
+        NDIlib_send_send_video_v2(_ndi_send_instance, &video_frame);
 
-    if(manual_free) {
-        delete[] video_frame.p_data;
+        av_buffer_unref(&packed_buffer);
     }
 
 #ifdef _DEBUG
@@ -201,27 +245,59 @@ AvError AsyncNDISource::_SendVideoFrame(const AVFrame *frame) {
     return AvError::NOERROR;
 }
 
+void AsyncNDISource::_FlushVideo() {
+    FUNCTION_CALL_DEBUG();
+
+    if(!_inflight_frame) {
+        return;
+    }
+
+    // A null frame blocks until the SDK has released the last async frame
+    NDIlib_send_send_video_async_v2(_ndi_send_instance, nullptr);
+
+    av_buffer_unref(&_inflight_buffer);
+    _inflight_frame.reset();
+}
+
 /**
- * Only send audio frames that are interleaved 16-bit signed PCM.
+ * Send audio frames that are planar 32-bit float (NDI's native format, sent as is)
+ * or interleaved 16-bit signed PCM.
  */
 AvError AsyncNDISource::_SendAudioFrame(const AVFrame *frame) {
     FUNCTION_CALL_DEBUG();
 
-    if(frame->format != AV_SAMPLE_FMT_S16) {
+    switch(frame->format) {
+    case AV_SAMPLE_FMT_FLTP: {
+        // NDI's native format, the samples go out without a conversion
+        NDIlib_audio_frame_v3_t audio_frame;
+
+        audio_frame.sample_rate = frame->sample_rate;
+        audio_frame.no_channels = frame->ch_layout.nb_channels;
+        audio_frame.no_samples = frame->nb_samples;
+        audio_frame.timecode = _timecode.Timecode(frame);
+        audio_frame.FourCC = NDIlib_FourCC_audio_type_FLTP;
+        audio_frame.p_data = PackPlanarAudio(frame, _audio_scratch, audio_frame.channel_stride_in_bytes);
+
+        NDIlib_send_send_audio_v3(_ndi_send_instance, &audio_frame);
+        break;
+    }
+    case AV_SAMPLE_FMT_S16: {
+        // Build NDI packet from frame
+        NDIlib_audio_frame_interleaved_16s_t audio_frame;
+
+        audio_frame.sample_rate = frame->sample_rate;
+        audio_frame.no_channels = frame->ch_layout.nb_channels;
+        audio_frame.no_samples = frame->nb_samples;
+        audio_frame.timecode = _timecode.Timecode(frame);
+        audio_frame.p_data = (int16_t *)frame->data[0];
+
+        // Send the frame, the SDK converts it to float planar
+        NDIlib_util_send_send_audio_interleaved_16s(_ndi_send_instance, &audio_frame);
+        break;
+    }
+    default:
         return AvError::INVALIDSMPLFMT;
     }
-    
-    // Build NDI packet from frame
-    NDIlib_audio_frame_interleaved_16s_t audio_frame;
-
-    audio_frame.sample_rate = frame->sample_rate;
-    audio_frame.no_channels = frame->ch_layout.nb_channels;
-    audio_frame.no_samples = frame->nb_samples;
-    audio_frame.timecode = NDIlib_send_timecode_synthesize;
-    audio_frame.p_data = (int16_t *)frame->data[0];
-
-    // Send the frame
-    NDIlib_util_send_send_audio_interleaved_16s(_ndi_send_instance, &audio_frame);
 
     return AvError::NOERROR;
 }
@@ -11,6 +11,8 @@
 // Local includes
 #include "averror.hpp"
 #include "ndi.hpp"
+#include "frame.hpp"
+#include "spscring.hpp"
 
 // NDI SDK
 #include <Processing.NDI.Lib.h>
@@ -23,11 +25,12 @@ extern "C" {
 // Standard C++ includes
 #include <string>
 #include <memory>
-#include <deque>
 #include <thread>
-#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <vector>
 
-#define FRAME_QUEUE_SIZE 50
+#define FRAME_QUEUE_SIZE 64
 
 namespace AV::Utils {
 
@@ -37,29 +40,56 @@ using AsyncNDISourceResult = std::pair<std::shared_ptr<AsyncNDISource>, const Av
 
 class AsyncNDISource : public NDI {
 private:
-    AsyncNDISource(const std::string &source_name, const AVRational &frame_rate);
+    AsyncNDISource(const std::string &source_name, const AVRational &frame_rate, bool async_video);
     AvError _Initialize();
-    AvError _SendVideoFrame(const AVFrame *frame);
+    AvError _SendVideoFrame(FramePtr &&frame);
+    void _FlushVideo();
     AvError _SendAudioFrame(const AVFrame *frame);
-    void _Thread_FrameSender();
+    void _Thread_VideoSender();
+    void _Thread_AudioSender();
+    void _SetVideoClock(int64_t pts_us);
 
 public:
     ~AsyncNDISource();
 
-    // Factory
-    static AsyncNDISourceResult Create(const std::string &source_name, const AVRational &frame_rate);
+    // Factory. With async_video the SDK compresses and transmits a frame while the
+    // next one is being prepared, the frame is held until the following send.
+    static AsyncNDISourceResult Create(const std::string &source_name, const AVRational &frame_rate, bool async_video = false);
 
-    AvException SendFrame(const AVFrame *frame);
+    // Only ever call this from one thread, the frame queues are single producer.
+    // The source takes ownership of the frame, on failure it is left with the caller.
+    AvException SendFrame(FramePtr &&frame);
+
+    // How many NV12 frames went out zero copy and how many had to be packed
+    NV12PackStats GetNV12Stats() const { return _nv12_packer.GetStats(); }
 
 private:
-    std::thread _frame_sender_thread;
+    std::thread _video_sender_thread;
+    std::thread _audio_sender_thread;
     std::string _source_name;
     NDIlib_send_instance_t _ndi_send_instance = nullptr;
     AVRational _frame_rate;
-    std::atomic<bool> _running = true;
+    bool _async_video = false;
+    NV12Packer _nv12_packer;
+
+    // Shared by both sender threads so audio and video timecodes start from the same epoch
+    NDITimecode _timecode;
+
+    // The frame the SDK may still be reading from in async mode, video sender thread only
+    FramePtr _inflight_frame;
+    AVBufferRef *_inflight_buffer = nullptr;
+
+    // Float planar audio that has to be packed before sending, audio sender thread only
+    std::vector<uint8_t> _audio_scratch;
+
+    // Video sends block for a frame period, so each media type gets its own queue and thread
+    SPSCRing<FramePtr, FRAME_QUEUE_SIZE> _video_queue;
+    SPSCRing<FramePtr, FRAME_QUEUE_SIZE> _audio_queue;
 
-    std::deque<AVFrame *> _frame_queue;
-    std::mutex _frame_queue_mutex;
+    // Pts (microseconds) of the video frame on the wire, audio is released against it.
+    // INT64_MAX while there is no video to pace against.
+    std::atomic<int64_t> _video_clock_us = INT64_MAX;
+    int64_t _video_frame_duration_us = 0;
 
 };
 
@@ -0,0 +1,194 @@
+/**
+ * @file audioaggregator.cpp
+ * @brief Regroups audio into chunks that line up with video frames
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include "audioaggregator.hpp"
+#include "macro.hpp"
+
+extern "C" {
+#include <libavutil/mathematics.h>
+}
+
+
+namespace AV::Utils {
+
+AudioAggregatorResult AudioAggregator::Create(const AudioAggregatorConfig &config) {
+    FUNCTION_CALL_DEBUG();
+
+    try {
+        return {std::unique_ptr<AudioAggregator>(new AudioAggregator(config)), AvError::NOERROR};
+    } catch (const AvException &e) {
+        DEBUG("Error creating audio aggregator: %s", e.what());
+        return {nullptr, e};
+    }
+}
+
+AudioAggregator::AudioAggregator(const AudioAggregatorConfig &config) : _config(config) {
+    FUNCTION_CALL_DEBUG();
+
+    AvError err = _Initialize();
+    if (err != AvError::NOERROR) {
+        throw AvException(err);
+    }
+}
+
+AudioAggregator::~AudioAggregator() {
+    FUNCTION_CALL_DEBUG();
+
+    if (_fifo) {
+        av_audio_fifo_free(_fifo);
+    }
+
+    // Chunks still in flight keep the pool alive until they are returned
+    av_buffer_pool_uninit(&_pool);
+}
+
+AvError AudioAggregator::_Initialize() {
+    FUNCTION_CALL_DEBUG();
+
+    const int channels = _config.ch_layout.nb_channels;
+    if (_config.sample_rate <= 0 || channels <= 0 || (av_sample_fmt_is_planar(_config.sample_fmt) && channels > AV_NUM_DATA_POINTERS)) {
+        return AvError::INVALIDSMPLFMT;
+    }
+
+    // Without a video rate there is nothing to line up with, use 20 ms chunks
+    if (_config.frame_rate.num <= 0 || _config.frame_rate.den <= 0) {
+        _config.frame_rate = {50, 1};
+    }
+
+    _max_chunk_samples = (int)av_rescale_rnd(1, (int64_t)_config.sample_rate * _config.frame_rate.den, _config.frame_rate.num, AV_ROUND_UP);
+
+    // Room for a couple of chunks, the fifo grows itself if a producer runs ahead
+    _fifo = av_audio_fifo_alloc(_config.sample_fmt, channels, _max_chunk_samples * 2);
+    if (!_fifo) {
+        return AvError::AUDIOFIFOALLOC;
+    }
+
+    int size = av_samples_get_buffer_size(nullptr, channels, _max_chunk_samples, _config.sample_fmt, 0);
+    if (size < 0) {
+        PRINT_FFMPEG_ERR(size);
+        return AvError::FRAMEALLOC;
+    }
+
+    _pool = av_buffer_pool_init(size, nullptr);
+    if (!_pool) {
+        return AvError::FRAMEALLOC;
+    }
+
+    DEBUG("Audio chunks of up to %d samples at %d/%d fps", _max_chunk_samples, _config.frame_rate.num, _config.frame_rate.den);
+
+    return AvError::NOERROR;
+}
+
+int AudioAggregator::GetChunkSamples(int64_t chunk) const {
+    return (int)(_ChunkStart(chunk + 1) - _ChunkStart(chunk));
+}
+
+int64_t AudioAggregator::_ChunkStart(int64_t chunk) const {
+    // Rounding down holds for negative chunks too, av_rescale_rnd rounds toward -infinity
+    return _grid_start + av_rescale_rnd(chunk, (int64_t)_config.sample_rate * _config.frame_rate.den, _config.frame_rate.num, AV_ROUND_DOWN);
+}
+
+AvException AudioAggregator::AddFrame(const AVFrame *frame) {
+    FUNCTION_CALL_DEBUG();
+
+    // The first frame anchors the timeline, everything after is counted in samples
+    if (_next_pts == AV_NOPTS_VALUE) {
+        const bool has_pts = frame->pts != AV_NOPTS_VALUE && frame->time_base.den != 0;
+
+        _next_pts = 0;
+        if (has_pts) {
+            _next_pts = av_rescale_q(frame->pts, frame->time_base, {1, _config.sample_rate});
+        }
+
+        // Where the audio starts on the video frame grid, later timelines keep the distance
+        if (_grid_offset == AV_NOPTS_VALUE) {
+            _grid_offset = 0;
+            if (has_pts && _config.start_us != AV_NOPTS_VALUE) {
+                _grid_offset = _next_pts - av_rescale_q(_config.start_us, {1, 1000000}, {1, _config.sample_rate});
+            }
+        }
+
+        // The first chunk only holds what is left of the frame period the audio starts in
+        _grid_start = _next_pts - _grid_offset;
+        _chunk_index = av_rescale_rnd(_grid_offset, _config.frame_rate.num, (int64_t)_config.sample_rate * _config.frame_rate.den, AV_ROUND_DOWN);
+        while (_ChunkStart(_chunk_index + 1) <= _next_pts) {
+            _chunk_index++;
+        }
+        while (_ChunkStart(_chunk_index) > _next_pts) {
+            _chunk_index--;
+        }
+    }
+
+    int ret = av_audio_fifo_write(_fifo, (void **)frame->extended_data, frame->nb_samples);
+    if (ret < frame->nb_samples) {
+        if (ret < 0) {
+            PRINT_FFMPEG_ERR(ret);
+        }
+
+        return AvError::AUDIOFIFOWRITE;
+    }
+
+    return AvError::NOERROR;
+}
+
+void AudioAggregator::Reset() {
+    FUNCTION_CALL_DEBUG();
+
+    av_audio_fifo_reset(_fifo);
+    _chunk_index = 0;
+    _next_pts = AV_NOPTS_VALUE;
+}
+
+AudioAggregatorOutput AudioAggregator::GetChunk(bool flush) {
+    FUNCTION_CALL_DEBUG();
+
+    // Nothing added since the timeline started
+    if (_next_pts == AV_NOPTS_VALUE) {
+        return {nullptr, AvError::AGGREGATOREXHAUSTED};
+    }
+
+    int queued = av_audio_fifo_size(_fifo);
+    int samples = (int)(_ChunkStart(_chunk_index + 1) - _next_pts);
+
+    if (queued < samples) {
+        if (!flush || queued == 0) {
+            return {nullptr, AvError::AGGREGATOREXHAUSTED};
+        }
+
+        samples = queued;
+    }
+
+    FramePtr chunk(av_frame_alloc());
+    if (!chunk) {
+        return {nullptr, AvError::FRAMEALLOC};
+    }
+
+    AVBufferRef *buffer = av_buffer_pool_get(_pool);
+    if (!buffer) {
+        return {nullptr, AvError::FRAMEALLOC};
+    }
+
+    // Point the chunk at a pooled buffer
+    chunk->buf[0] = buffer;
+    chunk->format = _config.sample_fmt;
+    chunk->sample_rate = _config.sample_rate;
+    av_channel_layout_copy(&chunk->ch_layout, &_config.ch_layout);
+    av_samples_fill_arrays(chunk->data, chunk->linesize, buffer->data, _config.ch_layout.nb_channels, _max_chunk_samples, _config.sample_fmt, 0);
+    chunk->extended_data = chunk->data;
+
+    chunk->nb_samples = av_audio_fifo_read(_fifo, (void **)chunk->extended_data, samples);
+    chunk->pts = _next_pts;
+    chunk->time_base = {1, _config.sample_rate};
+
+    _next_pts += chunk->nb_samples;
+    _chunk_index++;
+
+    return {std::move(chunk), AvError::NOERROR};
+}
+
+} // namespace AV::Utils
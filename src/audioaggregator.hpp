@@ -0,0 +1,117 @@
+/**
+ * @file audioaggregator.hpp
+ * @brief Regroups audio into chunks that line up with video frames
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#pragma once
+
+// Local includes
+#include "averror.hpp"
+#include "frame.hpp"
+
+// 3rd Party Dependencies
+extern "C" {
+#include <libavutil/audio_fifo.h>
+#include <libavutil/buffer.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/frame.h>
+#include <libavutil/samplefmt.h>
+}
+
+// Standard C++ Dependencies
+#include <cstdint>
+#include <memory>
+
+namespace AV::Utils {
+
+// Forward declarations and type definitions
+class AudioAggregator;
+using AudioAggregatorResult = std::pair<std::unique_ptr<AudioAggregator>, const AvException>;
+using AudioAggregatorOutput = std::pair<FramePtr, const AvException>;
+
+/**
+ * @brief The AudioAggregatorConfig struct represents the configuration for the AudioAggregator object.
+ */
+typedef struct AudioAggregatorConfig {
+    AVRational frame_rate{};   // Video frame rate the chunks follow, 20 ms chunks if unknown
+    int64_t start_us = AV_NOPTS_VALUE; // Time of the first video frame, unknown puts it at the first sample
+    int sample_rate{};
+    AVSampleFormat sample_fmt = AV_SAMPLE_FMT_FLTP;
+    AVChannelLayout ch_layout{};
+} AudioAggregatorConfig;
+
+/**
+ * @brief Collects decoded audio and hands it back one video frame period at a time.
+ *
+ * Chunk k holds the samples between video frames k and k + 1, rounded down, so
+ * fractional rates follow their natural cadence, 1602/1601/1602/1601/1602 for
+ * 48 kHz at 29.97. The frame grid starts at start_us. Audio that does not start on
+ * a video frame gets a shorter first chunk, so every later one ends on the grid.
+ * k is negative for audio ahead of the first video frame. Chunk pts are counted
+ * in samples from the first frame added.
+ */
+class AudioAggregator {
+private:
+    AudioAggregator(const AudioAggregatorConfig &config);
+    AvError _Initialize();
+
+public:
+    ~AudioAggregator();
+
+    // Factory
+    static AudioAggregatorResult Create(const AudioAggregatorConfig &config);
+
+    /**
+     * @brief Queue the samples of a frame, the frame is left untouched
+     *
+     * @param frame Audio in the configured format and layout
+     * @return AvException
+     */
+    AvException AddFrame(const AVFrame *frame);
+
+    /**
+     * @brief Get the next chunk. If there are not enough samples queued, it will return
+     * an error code of AGGREGATOREXHAUSTED
+     *
+     * @param flush Hand out whatever is left, even if it is short of a full chunk
+     * @return AudioAggregatorOutput The chunk, time base 1/sample_rate
+     */
+    AudioAggregatorOutput GetChunk(bool flush = false);
+
+    /**
+     * @brief Start a new timeline, the next frame added anchors the chunk pts again.
+     * Its first sample sits as far from the frame grid as the first sample of the
+     * timeline before, a looped pass moves audio and video alike.
+     * Anything still queued is dropped, flush it out with GetChunk(true) first.
+     */
+    void Reset();
+
+    /**
+     * @brief How many samples chunk number chunk holds when it is a full frame period
+     */
+    int GetChunkSamples(int64_t chunk) const;
+
+private:
+    // Sample position where chunk number chunk starts, on the frame grid
+    int64_t _ChunkStart(int64_t chunk) const;
+
+    AudioAggregatorConfig _config;
+
+    AVAudioFifo *_fifo = nullptr;
+
+    // Chunk buffers, each holds the largest chunk the cadence produces
+    AVBufferPool *_pool = nullptr;
+    int _max_chunk_samples = 0;
+
+    int64_t _chunk_index = 0;
+    int64_t _next_pts = AV_NOPTS_VALUE;
+
+    // Sample position of video frame 0, and how far the first sample is past it
+    int64_t _grid_start = 0;
+    int64_t _grid_offset = AV_NOPTS_VALUE;
+};
+
+} // namespace AV::Utils
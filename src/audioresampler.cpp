@@ -5,6 +5,7 @@
  * @author Matthew Todd Geiger
  */
 
+#include <algorithm>
 #include <chrono>
 
 #include "audioresampler.hpp"
@@ -12,6 +13,7 @@
 
 extern "C" {
 #include <libavutil/opt.h>
+#include <libavutil/samplefmt.h>
 }
 
 namespace AV::Utils {
@@ -28,43 +30,44 @@ FUNCTION_CALL_DEBUG();
     auto time_start = std::chrono::high_resolution_clock::now();
 #endif
 
-    // Unlike with the pixel encoder, the number of samples(or resolution for the pixel encoder) is not consistent
-    // so we need to reset the frame each time to be safe
-    //
-    // On modern machines this is extermely fast, but maybe in the future we can optimize this
-    // for smaller machines
+    // The context only needs rebuilding if the source changes mid stream
+    AvError err = m_Configure(src_frame);
+    if (err != AvError::NOERROR) {
+        return {nullptr, AvException(err)};
+    }
 
-    // Reset frame each time
-    av_frame_unref(m_dst_frame);
+    // Upper bound on what this call can produce, including what swr is holding on to
+    err = m_GrowCapacity(swr_get_out_samples(m_swr_context, src_frame->nb_samples));
+    if (err != AvError::NOERROR) {
+        return {nullptr, AvException(err)};
+    }
 
-    // Setup destination frame
-    m_dst_frame->ch_layout = m_config.dstchannellayout;
-    m_dst_frame->sample_rate = m_config.dstsamplerate;
-    m_dst_frame->format = m_config.dstsampleformat;
-    m_dst_frame->nb_samples = av_rescale_rnd(swr_get_delay(m_swr_context, m_config.srcsamplerate) + src_frame->nb_samples, m_config.dstsamplerate, m_config.srcsamplerate, AV_ROUND_UP);
-    m_dst_frame->pts = src_frame->pts;
+    // The previous output may have been moved out already, this is then a no-op
+    av_frame_unref(m_dst_frame);
 
-    // Allocate the frame buffer
-    int ret = av_frame_get_buffer(m_dst_frame, 0);
-    if (ret < 0) {
-        PRINT_FFMPEG_ERR(ret);
+    AVBufferRef *buffer = av_buffer_pool_get(m_pool);
+    if (!buffer) {
         return {nullptr, AvException(AvError::FRAMEALLOC)};
     }
 
-    // Configure the context for the frames, this could also be eventually optimized
-    ret = swr_config_frame(m_swr_context, m_dst_frame, src_frame);
-    if (ret < 0) {
-        PRINT_FFMPEG_ERR(ret);
-        return {nullptr, AvException(AvError::SWRCONFIG)};
-    }
+    // Point the frame at the pooled buffer
+    m_dst_frame->buf[0] = buffer;
+    m_dst_frame->format = m_config.dstsampleformat;
+    m_dst_frame->sample_rate = m_config.dstsamplerate;
+    av_channel_layout_copy(&m_dst_frame->ch_layout, &m_config.dstchannellayout);
+    av_samples_fill_arrays(m_dst_frame->data, m_dst_frame->linesize, buffer->data, m_config.dstchannellayout.nb_channels, m_capacity, m_config.dstsampleformat, 0);
+    m_dst_frame->extended_data = m_dst_frame->data;
 
     // Resample the frame
-    ret = swr_convert_frame(m_swr_context, m_dst_frame, src_frame);
+    int ret = swr_convert(m_swr_context, m_dst_frame->extended_data, m_capacity, (const uint8_t **)src_frame->extended_data, src_frame->nb_samples);
     if (ret < 0) {
         PRINT_FFMPEG_ERR(ret);
         return {nullptr, AvException(AvError::SWRCONVERT)};
     }
 
+    m_dst_frame->nb_samples = ret;
+    m_dst_frame->pts = src_frame->pts;
+
 #ifdef _DEBUG
     // Profile function
     auto time_end = std::chrono::high_resolution_clock::now();
@@ -74,6 +77,77 @@ FUNCTION_CALL_DEBUG();
     return {m_dst_frame, AvException(AvError::NOERROR)};
 }
 
+/**
+ * @brief Rebuild the swr context if the source frame no longer matches it
+ *
+ * @param src_frame The frame about to be resampled
+ * @return AvError
+ */
+AvError AudioResampler::m_Configure(const AVFrame *src_frame) {
+    if (src_frame->sample_rate == m_config.srcsamplerate && src_frame->format == m_config.srcsampleformat &&
+        av_channel_layout_compare(&src_frame->ch_layout, &m_config.srcchannellayout) == 0) {
+        return AvError::NOERROR;
+    }
+
+    DEBUG("Audio source changed, reconfiguring resampler");
+
+    m_config.srcsamplerate = src_frame->sample_rate;
+    m_config.srcsampleformat = (AVSampleFormat)src_frame->format;
+
+    // Custom layouts point into the frame, keep a copy of our own
+    av_channel_layout_uninit(&m_config.srcchannellayout);
+    int ret = av_channel_layout_copy(&m_config.srcchannellayout, &src_frame->ch_layout);
+    if (ret < 0) {
+        PRINT_FFMPEG_ERR(ret);
+        return AvError::AVMALLOC;
+    }
+
+    av_opt_set_chlayout(m_swr_context, "in_channel_layout", &m_config.srcchannellayout, 0);
+    av_opt_set_int(m_swr_context, "in_sample_rate", m_config.srcsamplerate, 0);
+    av_opt_set_sample_fmt(m_swr_context, "in_sample_fmt", m_config.srcsampleformat, 0);
+
+    ret = swr_init(m_swr_context);
+    if (ret < 0) {
+        PRINT_FFMPEG_ERR(ret);
+        return AvError::SWRINIT;
+    }
+
+    return AvError::NOERROR;
+}
+
+/**
+ * @brief Make sure the pooled output buffers hold at least nb_samples
+ *
+ * @param nb_samples Samples the next output needs room for
+ * @return AvError
+ */
+AvError AudioResampler::m_GrowCapacity(int nb_samples) {
+    if (nb_samples <= m_capacity && m_pool) {
+        return AvError::NOERROR;
+    }
+
+    // Grow geometrically so a stream settles on one size after a frame or two
+    int capacity = std::max(nb_samples, m_capacity * 2);
+
+    int size = av_samples_get_buffer_size(nullptr, m_config.dstchannellayout.nb_channels, capacity, m_config.dstsampleformat, 0);
+    if (size < 0) {
+        PRINT_FFMPEG_ERR(size);
+        return AvError::FRAMEALLOC;
+    }
+
+    // Buffers still in flight go back to the old pool, which frees itself once they do
+    av_buffer_pool_uninit(&m_pool);
+    m_pool = av_buffer_pool_init(size, nullptr);
+    if (!m_pool) {
+        return AvError::FRAMEALLOC;
+    }
+
+    m_capacity = capacity;
+    DEBUG("Resampler capacity: %d samples", m_capacity);
+
+    return AvError::NOERROR;
+}
+
 /**
  * @brief Create a new AudioResampler object
  *
@@ -122,6 +196,11 @@ AudioResampler::~AudioResampler() {
         DEBUG("Freeing swr context");
         swr_free(&m_swr_context);
     }
+
+    av_buffer_pool_uninit(&m_pool);
+
+    av_channel_layout_uninit(&m_config.srcchannellayout);
+    av_channel_layout_uninit(&m_config.dstchannellayout);
 }
 
 /**
@@ -132,6 +211,15 @@ AudioResampler::~AudioResampler() {
 AvError AudioResampler::m_Initialize() {
     FUNCTION_CALL_DEBUG();
 
+    // The config shares the caller's layouts, custom ones point at memory we don't own
+    const AVChannelLayout src_layout = m_config.srcchannellayout;
+    const AVChannelLayout dst_layout = m_config.dstchannellayout;
+    m_config.srcchannellayout = {};
+    m_config.dstchannellayout = {};
+    if (av_channel_layout_copy(&m_config.srcchannellayout, &src_layout) < 0 || av_channel_layout_copy(&m_config.dstchannellayout, &dst_layout) < 0) {
+        return AvError::AVMALLOC;
+    }
+
     // Alloc space for swr context
     m_swr_context = swr_alloc();
     if (!m_swr_context) {
@@ -167,6 +255,12 @@ AvError AudioResampler::m_Initialize() {
         return AvError::SWRINIT;
     }
 
+    // Planar output only has room for AV_NUM_DATA_POINTERS channels in the reused frame
+    if (av_sample_fmt_is_planar(m_config.dstsampleformat) && m_config.dstchannellayout.nb_channels > AV_NUM_DATA_POINTERS) {
+        DEBUG("Too many planar output channels: %d", m_config.dstchannellayout.nb_channels);
+        return AvError::SWRINIT;
+    }
+
     // Setup the destination frame
     m_dst_frame = av_frame_alloc();
     if (!m_dst_frame) {
@@ -12,6 +12,7 @@
 
 // 3rd party depednencies
 extern "C" {
+#include <libavutil/buffer.h>
 #include <libswresample/swresample.h>
 }
 
@@ -59,16 +60,25 @@ public:
     /**
      * @brief Resample the audio frame
      *
+     * The output frame is reused, its samples live in a pooled buffer so the caller
+     * may move the references out of it and keep them.
+     *
      * @param src_frame The frame to resample
      */
     AudioResamplerOutput Resample(AVFrame *src_frame);
 
 private:
     AvError m_Initialize();
+    AvError m_Configure(const AVFrame *src_frame);
+    AvError m_GrowCapacity(int nb_samples);
 
     AudioResamplerConfig m_config;
     SwrContext *m_swr_context = nullptr;
     AVFrame *m_dst_frame = nullptr;
+
+    // Output buffers, each holds m_capacity samples. Only ever grows.
+    AVBufferPool *m_pool = nullptr;
+    int m_capacity = 0;
 };
 
 } // namespace AV::Utils
\ No newline at end of file
@@ -130,6 +130,28 @@ const char *AvException::what() const noexcept {
         return DEMUXSTR " Error transferring hardware frame";
     case AvError::FRAMECOPY:
         return DEMUXSTR " Error copying frame";
+    case AvError::FILTEREXHAUSTED:
+        return DEMUXSTR " Filter is exhausted";
+    case AvError::UNSUPPORTEDPIXFMT:
+        return DEMUXSTR " Unsupported pixel format";
+    case AvError::UNSUPPORTEDCPU:
+        return DEMUXSTR " Instruction set not supported by this CPU";
+    case AvError::AUDIOFIFOALLOC:
+        return DEMUXSTR " Error allocating audio fifo";
+    case AvError::AUDIOFIFOWRITE:
+        return DEMUXSTR " Error writing to audio fifo";
+    case AvError::AGGREGATOREXHAUSTED:
+        return DEMUXSTR " Audio aggregator needs more samples";
+    case AvError::NDINOOUTPUTS:
+        return DEMUXSTR " No NDI outputs configured";
+    case AvError::SEEK:
+        return DEMUXSTR " Failed to seek";
+    case AvError::CACHEOPEN:
+        return DEMUXSTR " Failed to open playout cache";
+    case AvError::CACHEWRITE:
+        return DEMUXSTR " Failed to write playout cache";
+    case AvError::CACHEINVALID:
+        return DEMUXSTR " Playout cache is invalid or does not match";
     default:
         return DEMUXSTR " Unknown error";
     }
@@ -65,7 +65,18 @@ enum class AvError {
     NOHWCONFIG,
     NOPIXFMT,
     HWFRAME_TRANSFER,
-    FRAMECOPY
+    FRAMECOPY,
+    FILTEREXHAUSTED,
+    UNSUPPORTEDPIXFMT,
+    UNSUPPORTEDCPU,
+    AUDIOFIFOALLOC,
+    AUDIOFIFOWRITE,
+    AGGREGATOREXHAUSTED,
+    NDINOOUTPUTS,
+    SEEK,
+    CACHEOPEN,
+    CACHEWRITE,
+    CACHEINVALID
 };
 
 /**
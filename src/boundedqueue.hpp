@@ -0,0 +1,143 @@
+/**
+ * @file boundedqueue.hpp
+ * @brief Blocking bounded queue used to join pipeline stages
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#pragma once
+
+// Standard C++ Dependencies
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+// Defines
+#define AVUTILS_FRAME_QUEUE_CAPACITY 8
+
+namespace AV::Utils {
+
+/**
+ * @brief A blocking queue with a fixed capacity.
+ *
+ * Producers block while the queue is full and consumers block while it is empty.
+ * Close() lets consumers drain whatever is left, Abort() wakes everybody up and
+ * makes every blocking call fail so that stage threads can unwind after an error.
+ *
+ * The queue does not own what it stores, anything left inside after an abort
+ * has to be pulled out with TryPop() and released by the caller.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    BoundedQueue(const size_t capacity) : _capacity(capacity) {}
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    /**
+     * @brief Push an item, blocking while the queue is full
+     *
+     * @param item The item to push
+     * @return bool False if the queue was closed or aborted, the caller keeps ownership of the item
+     */
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _not_full.wait(lock, [this] { return _queue.size() < _capacity || _closed || _aborted; });
+
+        if (_closed || _aborted) {
+            return false;
+        }
+
+        _queue.push_back(std::move(item));
+        lock.unlock();
+
+        _not_empty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Pop an item, blocking while the queue is empty
+     *
+     * @param item Receives the popped item
+     * @return bool False once the queue is closed and drained, or aborted
+     */
+    bool Pop(T &item) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _not_empty.wait(lock, [this] { return !_queue.empty() || _closed || _aborted; });
+
+        if (_aborted || _queue.empty()) {
+            return false;
+        }
+
+        item = std::move(_queue.front());
+        _queue.pop_front();
+        lock.unlock();
+
+        _not_full.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Pop an item without blocking. This also works after an abort
+     * so leftovers can be released.
+     *
+     * @param item Receives the popped item
+     * @return bool False if the queue is empty
+     */
+    bool TryPop(T &item) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_queue.empty()) {
+            return false;
+        }
+
+        item = std::move(_queue.front());
+        _queue.pop_front();
+        lock.unlock();
+
+        _not_full.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Stop accepting new items, consumers can still drain the queue
+     */
+    void Close() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _closed = true;
+        lock.unlock();
+
+        _not_empty.notify_all();
+        _not_full.notify_all();
+    }
+
+    /**
+     * @brief Wake up all waiters and fail every blocking call from now on
+     */
+    void Abort() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _aborted = true;
+        lock.unlock();
+
+        _not_empty.notify_all();
+        _not_full.notify_all();
+    }
+
+    size_t Size() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _queue.size();
+    }
+
+private:
+    std::deque<T> _queue;
+    std::mutex _mutex;
+    std::condition_variable _not_empty;
+    std::condition_variable _not_full;
+    size_t _capacity;
+    bool _closed = false;
+    bool _aborted = false;
+};
+
+} // namespace AV::Utils
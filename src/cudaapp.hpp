@@ -10,19 +10,9 @@
 
 // Local includes
 #include "averror.hpp"
-#include "demuxer.hpp"
-#include "asyncndisource.hpp"
-#include "decoder.hpp"
-#include "pixelencoder.hpp"
-#include "audioresampler.hpp"
-#include "frametimer.hpp"
-#include "cudadecoder.hpp"
+#include "pipelinepolicies.hpp"
 #include "app.hpp"
 
-extern "C" {
-	#include <libavcodec/codec_par.h>
-}
-
 // Standard C++ includes
 #include <string>
 #include <memory>
@@ -32,28 +22,19 @@ using CudaAppResult = std::pair<std::shared_ptr<CudaApp>, AV::Utils::AvException
 
 class CudaApp : public App {
 private:
-	CudaApp(const std::string &ndi_source_name, const std::string &video_file_path);
+	CudaApp(const AV::Utils::PipelineConfig &config);
 	AV::Utils::AvError _Initialize();
 
 public:
 	~CudaApp() = default;
 
 	// Factory
-	static CudaAppResult Create(const std::string &ndi_source_name, const std::string &video_file_path);
+	static CudaAppResult Create(const AV::Utils::PipelineConfig &config);
 
 	AV::Utils::AvException Run() override;
 
 private:
-	std::string _ndi_source_name;
-	std::string _video_file_path;
-	std::shared_ptr<AV::Utils::Demuxer> _demuxer;
-	std::shared_ptr<AV::Utils::Decoder> _audio_decoder;
-	std::shared_ptr<AV::Utils::CudaDecoder> _cuda_video_decoder;
-	std::shared_ptr<AV::Utils::AudioResampler> _audio_resampler;
-	std::shared_ptr<AV::Utils::AsyncNDISource> _ndi_source;
-	
-	AV::Utils::FrameTimer _frame_timer;
-
-	int _video_stream_index = -1;
-	int _audio_stream_index = -1;
+	AV::Utils::PipelineConfig _config;
+	std::unique_ptr<AV::Utils::CudaPipeline> _pipeline;
+	std::unique_ptr<AV::Utils::CudaUYVYPipeline> _uyvy_pipeline; // Used instead with PipelineConfig::pack_uyvy
 };
\ No newline at end of file
@@ -36,53 +36,53 @@ CudaFilter::~CudaFilter() {
     if(_filter_graph) {
         avfilter_graph_free(&_filter_graph);
     }
+
+    if(_filtered_frame) {
+        av_frame_free(&_filtered_frame);
+    }
 }
 
-CudaFilterOutput CudaFilter::FilterFrame(AVFrame *frame) {
+AvException CudaFilter::FillFilter(FramePtr &&frame) {
     FUNCTION_CALL_DEBUG();
 
-    std::vector<AVFrame *> filtered_frames;
-
-    // Create a frame
-    AVFrame *filtered_frame = av_frame_alloc();
-    if (!filtered_frame) {
-        return {filtered_frames, AvError::FRAMEALLOC};
-    }
-
-    // Set the frame parameters
-    int ret = av_buffersrc_add_frame(_buffersrc_ctx, frame);
+    // The graph moves the references out, only the empty frame is left to free
+    int ret = av_buffersrc_add_frame(_buffersrc_ctx, frame.get());
     if (ret < 0) {
-        return {filtered_frames, AvError::BUFFERSRC_ADD_FRAME};
+        PRINT_FFMPEG_ERR(ret);
+        return AvError::BUFFERSRC_ADD_FRAME;
     }
 
-    // Pull filtered frames from the sink
-    while (true) {
-        ret = av_buffersink_get_frame(_buffersink_ctx, filtered_frame);
-        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-            break;
-        }
-
-        if (ret < 0) {
-            return {filtered_frames, AvError::BUFFERSINK_GET_FRAME};
-        }
-
-        // Copy the frame
-        AVFrame *new_frame = av_frame_clone(filtered_frame);
-        if (!new_frame) {
-            return {filtered_frames, AvError::FRAMEALLOC};
-        }
-
-        filtered_frames.push_back(new_frame);
-        av_frame_unref(filtered_frame);
+    frame.reset();
+
+    return AvError::NOERROR;
+}
+
+CudaFilterOutput CudaFilter::FilterFrame() {
+    FUNCTION_CALL_DEBUG();
+
+    // Drop the references handed out by the previous call
+    av_frame_unref(_filtered_frame);
+
+    int ret = av_buffersink_get_frame(_buffersink_ctx, _filtered_frame);
+    if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        return {nullptr, AvError::FILTEREXHAUSTED};
+    } else if (ret < 0) {
+        PRINT_FFMPEG_ERR(ret);
+        return {nullptr, AvError::BUFFERSINK_GET_FRAME};
     }
 
-    av_frame_free(&filtered_frame);
-    return {filtered_frames, AvError::NOERROR};
+    return {_filtered_frame, AvError::NOERROR};
 }
 
 AvError CudaFilter::_Initialize(const std::string &filter_description, const AVCodecParameters *codec_parameters, const AVRational &time_base, AVPixelFormat output_format) {
     FUNCTION_CALL_DEBUG();
 
+    // Allocate the frame filtered output is received into
+    _filtered_frame = av_frame_alloc();
+    if (!_filtered_frame) {
+        return AvError::FRAMEALLOC;
+    }
+
     // Create filter graph
     _filter_graph = avfilter_graph_alloc();
     if (_filter_graph == nullptr) {
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "averror.hpp"
+#include "frame.hpp"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -20,13 +21,12 @@ extern "C" {
 
 #include <memory>
 #include <string>
-#include <vector>
 
 namespace AV::Utils {
 
 class CudaFilter;
 using CudaFilterResult = std::pair<std::unique_ptr<CudaFilter>, const AvException>;
-using CudaFilterOutput = std::pair<std::vector<AVFrame *>, const AvException>;
+using CudaFilterOutput = std::pair<AVFrame *, const AvException>;
 
 class CudaFilter {
 private:
@@ -37,12 +37,31 @@ private:
 public:
     ~CudaFilter();
     static CudaFilterResult Create(const std::string &filter_description, const AVCodecParameters *codec_parameters, const AVRational &time_base, AVPixelFormat output_format);
-    CudaFilterOutput FilterFrame(AVFrame *frame);
+    /**
+     * @brief Push a frame into the filter graph
+     *
+     * @param frame The frame to filter, the graph takes ownership of it. A null frame flushes the graph.
+     * @return AvException
+     */
+    AvException FillFilter(FramePtr &&frame);
+
+    /**
+     * @brief Pull the next filtered frame. If the graph needs another frame, it will return
+     * an error code of FILTEREXHAUSTED
+     *
+     * The frame is owned by the filter and stays valid until the next call.
+     *
+     * @return CudaFilterOutput
+     */
+    CudaFilterOutput FilterFrame();
 
 private:
     AVFilterGraph *_filter_graph = nullptr;
     AVFilterContext *_buffersrc_ctx = nullptr;
     AVFilterContext *_buffersink_ctx = nullptr;
+
+    // Reused for every filtered frame
+    AVFrame *_filtered_frame = nullptr;
 };
 
 } // namespace AV::Utils
\ No newline at end of file
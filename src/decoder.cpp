@@ -8,7 +8,9 @@
 #include "decoder.hpp"
 #include "macro.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <thread>
 
 namespace AV::Utils {
 
@@ -43,6 +45,15 @@ AvException Decoder::FillDecoder(AVPacket *packet) {
     return AvException(AvError::NOERROR);
 }
 
+/**
+ * @brief Drop everything the Decoder holds and leave draining mode
+ */
+void Decoder::Flush() {
+    FUNCTION_CALL_DEBUG();
+
+    avcodec_flush_buffers(m_codec);
+}
+
 /**
  * @brief Decode a packet
  *
@@ -78,16 +89,17 @@ DecoderOutput Decoder::Decode() {
  * @brief Create a Decoder object
  *
  * @param codecpar codec parameters
+ * @param config threading policy
  * @return DecoderResult
  */
-DecoderResult Decoder::Create(AVCodecParameters *codecpar) {
+DecoderResult Decoder::Create(AVCodecParameters *codecpar, const DecoderConfig &config) {
     FUNCTION_CALL_DEBUG();
 
     AvException error;
 
     // Create a new decoder object, return nullopt if error
     try {
-        return {std::unique_ptr<Decoder>(new Decoder(codecpar)), error};
+        return {std::unique_ptr<Decoder>(new Decoder(codecpar, config)), error};
     } catch (AvException e) {
         error = e;
         DEBUG("Decoder error: %s", error.what());
@@ -101,7 +113,7 @@ DecoderResult Decoder::Create(AVCodecParameters *codecpar) {
  *
  * @param codec_id codec ID
  */
-Decoder::Decoder(AVCodecParameters *codecpar) : m_codecpar(codecpar) {
+Decoder::Decoder(AVCodecParameters *codecpar, const DecoderConfig &config) : m_codecpar(codecpar), m_config(config) {
     FUNCTION_CALL_DEBUG();
 
     AvError err = m_Initialize();
@@ -160,6 +172,33 @@ AvError Decoder::m_Initialize() {
         return AvError::DECPARAMS;
     }
 
+    // Apply the threading policy, an unset count shares the cores between channels
+    int thread_count = m_config.thread_count;
+    if (thread_count <= 0) {
+        thread_count = std::max(1, (int)std::thread::hardware_concurrency() / std::max(1, m_config.channels));
+    }
+
+    switch (m_config.thread_type) {
+    case DecoderThreadType::BOTH:
+        m_codec->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        break;
+    case DecoderThreadType::FRAME:
+        m_codec->thread_type = FF_THREAD_FRAME;
+        break;
+    case DecoderThreadType::SLICE:
+        m_codec->thread_type = FF_THREAD_SLICE;
+        break;
+    case DecoderThreadType::NONE:
+        thread_count = 1;
+        break;
+    }
+
+    m_codec->thread_count = thread_count;
+
+    if (m_config.pooled_buffers) {
+        m_buffer_pool.Attach(m_codec);
+    }
+
     // Open the decoder context
     ret = avcodec_open2(m_codec, codec, nullptr);
     if (ret < 0) {
@@ -168,6 +207,8 @@ AvError Decoder::m_Initialize() {
         return AvError::DECPARAMS;
     }
 
+    DEBUG("Decoder threads: %d | requested type: %d | active type: %d", m_codec->thread_count, m_codec->thread_type, m_codec->active_thread_type);
+
     // Allocate frame
     m_last_frame = av_frame_alloc();
     if (!m_last_frame) {
@@ -10,6 +10,7 @@
 // Local dependencies
 #include "averror.hpp"
 #include "demuxer.hpp"
+#include "framepool.hpp"
 
 // 3rd party dependencies
 extern "C" {
@@ -27,12 +28,35 @@ using DecoderResult = std::pair<std::unique_ptr<Decoder>, const AvException>;
 using DecoderOutput = std::pair<AVFrame *, const AvException>;
 using CodecFrameRate = std::pair<int, int>;
 
+/**
+ * @brief How the decoder spreads work across threads
+ */
+enum class DecoderThreadType {
+    FRAME,
+    SLICE,
+    BOTH, // libavcodec picks whichever of the two the codec supports, preferring frame threads
+    NONE
+};
+
+/**
+ * @brief The DecoderConfig struct represents the threading and allocation policy of a Decoder.
+ *
+ * A thread_count of 0 is auto, the cores of the host are divided evenly between the channels
+ * running on it, so one channel gets every core and many channels do not oversubscribe.
+ */
+typedef struct DecoderConfig {
+    DecoderThreadType thread_type = DecoderThreadType::BOTH;
+    int thread_count = 0;
+    int channels = 1;
+    bool pooled_buffers = true; // Decode video into a FrameBufferPool instead of libavcodec's own buffers
+} DecoderConfig;
+
 /**
  * @brief The Decoder class provides utilities for decoding media files.
  */
 class Decoder {
 private:
-    Decoder(AVCodecParameters *codecpar);
+    Decoder(AVCodecParameters *codecpar, const DecoderConfig &config);
 
 public:
     /**
@@ -44,9 +68,10 @@ public:
      * @brief Create a Decoder object
      *
      * @param codecpar codec parameters
+     * @param config threading policy
      * @return DecoderResult
      */
-    static DecoderResult Create(AVCodecParameters *codecpar);
+    static DecoderResult Create(AVCodecParameters *codecpar, const DecoderConfig &config = DecoderConfig());
 
     // Setters
     /**
@@ -65,6 +90,12 @@ public:
      */
     DecoderOutput Decode();
 
+    /**
+     * @brief Drop everything the Decoder holds and leave draining mode,
+     * call after a seek or once it has been drained with a null packet
+     */
+    void Flush();
+
     // Getters
     /**
      * @brief Get the frame rate of the decoder
@@ -79,11 +110,17 @@ private:
     // Store the codec parameters
     AVCodecParameters *m_codecpar = nullptr;
 
+    // Store the threading policy
+    DecoderConfig m_config;
+
     // This is the codec context that ffmpeg uses to decode the media file
     AVCodecContext *m_codec = nullptr;
 
     // This is the last frame that was decoded
     AVFrame *m_last_frame = nullptr;
+
+    // Backs decoded video frames when pooled_buffers is set
+    FrameBufferPool m_buffer_pool;
 };
 
 } // namespace AV::Utils
\ No newline at end of file
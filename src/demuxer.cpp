@@ -6,8 +6,19 @@
  */
 
 #include "demuxer.hpp"
+#include "streaminfocache.hpp"
 #include "macro.hpp"
 
+// POSIX includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Standard C++ dependencies
+#include <algorithm>
+#include <cstring>
+
 /**
  * @brief The AV::Utils namespace contains utilities for audio and video processing.
  */
@@ -59,13 +70,32 @@ ReadFrameResult Demuxer::ReadFrame() {
     return {m_packet, AvException(AvError::NOERROR)};
 }
 
+/**
+ * @brief Seek to the last keyframe at or before a timestamp.
+ *
+ * @param timestamp Microseconds (AV_TIME_BASE)
+ * @return AvException
+ */
+AvException Demuxer::Seek(int64_t timestamp) {
+    FUNCTION_CALL_DEBUG();
+
+    int ret = avformat_seek_file(m_format_ctx, -1, INT64_MIN, timestamp, timestamp, 0);
+    if (ret < 0) {
+        PRINT_FFMPEG_ERR(ret);
+        return AvException(AvError::SEEK);
+    }
+
+    return AvException(AvError::NOERROR);
+}
+
 /**
  * @brief Create a Demuxer object
  *
  * @param path path to media file
+ * @param config How the file is read
  * @return DemuxerResult
  */
-DemuxerResult Demuxer::Create(const std::string &path) {
+DemuxerResult Demuxer::Create(const std::string &path, const DemuxerConfig &config) {
     FUNCTION_CALL_DEBUG();
 
     AvException error;
@@ -75,7 +105,7 @@ DemuxerResult Demuxer::Create(const std::string &path) {
     // So I'm going to do it for them.
     // You're welcome.
     try {
-        return {std::unique_ptr<Demuxer>(new Demuxer(path)), AvException(AvError::NOERROR)};
+        return {std::unique_ptr<Demuxer>(new Demuxer(path, config)), AvException(AvError::NOERROR)};
     } catch (AvException err) {
         DEBUG("Demuxer error: %s", err.what());
         error = err;
@@ -88,8 +118,9 @@ DemuxerResult Demuxer::Create(const std::string &path) {
  * @brief Construct a new Demuxer:: Demuxer object
  *
  * @param path path to media file
+ * @param config How the file is read
  */
-Demuxer::Demuxer(const std::string &path) : m_path(path) {
+Demuxer::Demuxer(const std::string &path, const DemuxerConfig &config) : m_path(path), m_config(config) {
     FUNCTION_CALL_DEBUG();
 
     AvError err = m_Initialize();
@@ -115,6 +146,131 @@ Demuxer::~Demuxer() {
         avformat_close_input(&m_format_ctx);
         DEBUG("avformat_close_input called");
     }
+
+    // A custom IO context outlives the format context, its buffer may have been replaced by libavformat
+    if (m_io_ctx != nullptr) {
+        av_freep(&m_io_ctx->buffer);
+        avio_context_free(&m_io_ctx);
+        DEBUG("avio_context_free called");
+    }
+
+    if (m_map != nullptr) {
+        munmap(m_map, m_map_size);
+        DEBUG("munmap called");
+    }
+}
+
+/**
+ * @brief Serve a read of libavformat from the mapping
+ *
+ * @param opaque The Demuxer
+ * @param buf Where to copy to
+ * @param buf_size How much to copy at most
+ * @return int Bytes copied or AVERROR_EOF
+ */
+int Demuxer::m_ReadMapped(void *opaque, uint8_t *buf, int buf_size) {
+    Demuxer *demuxer = (Demuxer *)opaque;
+
+    size_t size = std::min((size_t)buf_size, demuxer->m_map_size - demuxer->m_map_pos);
+    if (size == 0) {
+        return AVERROR_EOF;
+    }
+
+    memcpy(buf, demuxer->m_map + demuxer->m_map_pos, size);
+    demuxer->m_map_pos += size;
+
+    return (int)size;
+}
+
+/**
+ * @brief Move the read position in the mapping
+ *
+ * @param opaque The Demuxer
+ * @param offset Where to, relative to whence
+ * @param whence SEEK_SET, SEEK_CUR, SEEK_END or AVSEEK_SIZE
+ * @return int64_t The new position, the file size for AVSEEK_SIZE, or an error
+ */
+int64_t Demuxer::m_SeekMapped(void *opaque, int64_t offset, int whence) {
+    Demuxer *demuxer = (Demuxer *)opaque;
+
+    int64_t pos = 0;
+    switch (whence & ~AVSEEK_FORCE) {
+    case AVSEEK_SIZE:
+        return (int64_t)demuxer->m_map_size;
+    case SEEK_SET:
+        pos = offset;
+        break;
+    case SEEK_CUR:
+        pos = (int64_t)demuxer->m_map_pos + offset;
+        break;
+    case SEEK_END:
+        pos = (int64_t)demuxer->m_map_size + offset;
+        break;
+    default:
+        return AVERROR(EINVAL);
+    }
+
+    if (pos < 0 || pos > (int64_t)demuxer->m_map_size) {
+        return AVERROR(EINVAL);
+    }
+
+    demuxer->m_map_pos = (size_t)pos;
+    return pos;
+}
+
+/**
+ * @brief Map the media file and set up a custom IO context reading from it
+ *
+ * @return AvError
+ */
+AvError Demuxer::m_MapInput() {
+    FUNCTION_CALL_DEBUG();
+
+    int fd = open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return AvError::OPENINPUT;
+    }
+
+    // Only regular files can be mapped, anything else goes through libavformat's own protocols
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        close(fd);
+        return AvError::OPENINPUT;
+    }
+
+    m_map_size = (size_t)st.st_size;
+
+    // Short files are paged in right away, long ones are read ahead as they play
+    int flags = MAP_PRIVATE;
+    if (m_map_size <= AVUTILS_DEMUXER_MMAP_POPULATE_LIMIT) {
+        flags |= MAP_POPULATE;
+    }
+
+    void *map = mmap(nullptr, m_map_size, PROT_READ, flags, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        DEBUG("mmap failed: %s", strerror(errno));
+        return AvError::OPENINPUT;
+    }
+
+    m_map = (uint8_t *)map;
+    madvise(m_map, m_map_size, MADV_SEQUENTIAL);
+
+    uint8_t *buffer = (uint8_t *)av_malloc(AVUTILS_DEMUXER_MMAP_BUFFER_SIZE);
+    if (buffer == nullptr) {
+        return AvError::OPENINPUT;
+    }
+
+    m_io_ctx = avio_alloc_context(buffer, AVUTILS_DEMUXER_MMAP_BUFFER_SIZE, 0, this, &Demuxer::m_ReadMapped, nullptr, &Demuxer::m_SeekMapped);
+    if (m_io_ctx == nullptr) {
+        av_free(buffer);
+        return AvError::OPENINPUT;
+    }
+
+    DEBUG("Memory mapped %s, %lu bytes", m_path.c_str(), m_map_size);
+
+    return AvError::NOERROR;
 }
 
 /**
@@ -125,8 +281,35 @@ Demuxer::~Demuxer() {
 AvError Demuxer::m_Initialize() {
     FUNCTION_CALL_DEBUG();
 
+    // Read through a memory mapping if asked to, local files only
+    if (m_config.memory_map && m_MapInput() != AvError::NOERROR) {
+        DEBUG("Not memory mapping %s, reading it through libavformat", m_path.c_str());
+    }
+
+    if (m_io_ctx != nullptr) {
+        m_format_ctx = avformat_alloc_context();
+        if (m_format_ctx == nullptr) {
+            DEBUG("avformat_alloc_context failed");
+            return AvError::OPENINPUT;
+        }
+
+        m_format_ctx->pb = m_io_ctx;
+        m_format_ctx->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
+
+    // Bound how much is read and decoded to find the streams
+    AVDictionary *options = nullptr;
+    if (m_config.probesize > 0) {
+        av_dict_set_int(&options, "probesize", m_config.probesize, 0);
+    }
+
+    if (m_config.analyze_duration_us > 0) {
+        av_dict_set_int(&options, "analyzeduration", m_config.analyze_duration_us, 0);
+    }
+
     // Create the format context
-    int ret = avformat_open_input(&m_format_ctx, m_path.c_str(), nullptr, nullptr);
+    int ret = avformat_open_input(&m_format_ctx, m_path.c_str(), nullptr, &options);
+    av_dict_free(&options);
     if (ret < 0) {
         DEBUG("avformat_open_input failed");
         PRINT_FFMPEG_ERR(ret);
@@ -140,6 +323,22 @@ AvError Demuxer::m_Initialize() {
         return AvError::PACKETALLOC;
     }
 
+    // A file opened before gets its stream information from the sidecar, no probing needed
+    std::string stream_info_path;
+    if (!m_config.stream_info_cache_dir.empty()) {
+        stream_info_path = StreamInfoCachePath(m_config.stream_info_cache_dir, m_path);
+
+        auto err = LoadStreamInfo(stream_info_path, m_path, m_format_ctx);
+        if (err.code() == 0) {
+            DEBUG("Stream info of %s loaded from %s", m_path.c_str(), stream_info_path.c_str());
+            return AvError::NOERROR;
+        }
+
+        if ((AvError)err.code() != AvError::CACHEOPEN) {
+            DEBUG("Probing %s again: %s", m_path.c_str(), err.what());
+        }
+    }
+
     // Load the stream information into the format context
     ret = avformat_find_stream_info(m_format_ctx, nullptr);
     if (ret < 0) {
@@ -148,6 +347,13 @@ AvError Demuxer::m_Initialize() {
         return AvError::FINDSTREAMINFO;
     }
 
+    if (!stream_info_path.empty()) {
+        auto err = StoreStreamInfo(stream_info_path, m_path, m_format_ctx);
+        if (err.code()) {
+            DEBUG("Not caching the stream info of %s: %s", m_path.c_str(), err.what());
+        }
+    }
+
     return AvError::NOERROR;
 }
 
@@ -16,13 +16,31 @@ extern "C" {
 }
 
 // Standard C++ dependencies
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
+// Buffer libavformat reads a memory mapped file through, larger reads are copied straight out of the mapping
+#define AVUTILS_DEMUXER_MMAP_BUFFER_SIZE (32 * 1024)
+
+// Memory mapped files up to this size are paged in up front
+#define AVUTILS_DEMUXER_MMAP_POPULATE_LIMIT (256 * 1024 * 1024)
+
 namespace AV::Utils {
 
+/**
+ * @brief The DemuxerConfig struct represents the configuration for the Demuxer object.
+ */
+typedef struct DemuxerConfig {
+    bool memory_map = false; // Serve reads of a local file from a memory mapping instead of read() calls
+    int64_t probesize = 0; // Bytes read to find the format and streams, 0 keeps libavformat's default
+    int64_t analyze_duration_us = 0; // Media decoded to find stream parameters, 0 keeps libavformat's default
+    std::string stream_info_cache_dir; // Reopens of a known file take its stream info from here instead of probing, empty disables
+} DemuxerConfig;
+
 // Forward declarations and type definitions
 class Demuxer;
 using DemuxerResult = std::pair<std::unique_ptr<Demuxer>, const AvException>;
@@ -35,7 +53,7 @@ using ReadFrameResult = std::pair<AVPacket *, const AvException>;
  */
 class Demuxer {
 private:
-    Demuxer(const std::string &path); // I'm keeping the constructor private so that it can only be called by the factory method
+    Demuxer(const std::string &path, const DemuxerConfig &config); // I'm keeping the constructor private so that it can only be called by the factory method
 
 public:
     /**
@@ -54,9 +72,10 @@ public:
      * @brief Create a Demuxer object
      *
      * @param path path to media file
+     * @param config How the file is read
      * @return DemuxerResult
      */
-    static DemuxerResult Create(const std::string &path);
+    static DemuxerResult Create(const std::string &path, const DemuxerConfig &config = {});
 
     // Getters
     
@@ -67,6 +86,15 @@ public:
      */
     ReadFrameResult ReadFrame();
 
+    /**
+     * @brief Seek to the last keyframe at or before a timestamp. The streams,
+     * codec parameters and packet are kept, reading continues from there.
+     *
+     * @param timestamp Microseconds (AV_TIME_BASE)
+     * @return AvException
+     */
+    AvException Seek(int64_t timestamp);
+
     /**
      * @brief Get the AVStream pointers that were generated by ffmpeg.
      * This is useful for getting the stream information inexpensively
@@ -78,9 +106,22 @@ public:
 
 private:
     AvError m_Initialize();
+    AvError m_MapInput();
+
+    static int m_ReadMapped(void *opaque, uint8_t *buf, int buf_size);
+    static int64_t m_SeekMapped(void *opaque, int64_t offset, int whence);
 
     // Store the path to the media file
     std::string m_path;
+    DemuxerConfig m_config;
+
+    // The memory mapped file and where libavformat is reading in it
+    uint8_t *m_map = nullptr;
+    size_t m_map_size = 0;
+    size_t m_map_pos = 0;
+
+    // Custom IO context reading from the mapping, owned by us rather than the format context
+    AVIOContext *m_io_ctx = nullptr;
 
     // This is the api context that ffmpeg uses to read the media file
     AVFormatContext *m_format_ctx = nullptr;
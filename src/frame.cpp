@@ -9,7 +9,10 @@
 #include "frame.hpp"
 #include "macro.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <climits>
+#include <cstring>
 
 extern "C" {
 #include <libavutil/imgutils.h>
@@ -38,6 +41,22 @@ AVFrame *CopyFrame(AVFrame *frame) {
     return new_frame;
 }
 
+/**
+ * @brief Move the references out of a reused frame
+ * @param frame The reused frame
+ * @return FramePtr The new owner of the frame's buffers
+ */
+FramePtr TakeFrame(AVFrame *frame) {
+    FUNCTION_CALL_DEBUG();
+
+    FramePtr owned_frame(av_frame_alloc());
+    if (owned_frame) {
+        av_frame_move_ref(owned_frame.get(), frame);
+    }
+
+    return owned_frame;
+}
+
 /**
  * @brief Combine all planes of NV12 into single buffer
  * 
@@ -150,4 +169,137 @@ uint8_t *CombinePlanesNV12(const AVFrame *frame, uint planes) {
     return target_buffer;
 }
 
+bool IsContiguousNV12(const AVFrame *frame) {
+    return frame->linesize[0] == frame->linesize[1] &&
+           frame->data[1] == frame->data[0] + (ptrdiff_t)frame->linesize[0] * frame->height;
+}
+
+uint8_t *PackPlanarAudio(const AVFrame *frame, std::vector<uint8_t> &scratch, int &channel_stride) {
+    FUNCTION_CALL_DEBUG();
+
+    const int channels = frame->ch_layout.nb_channels;
+    const int plane_size = frame->nb_samples * sizeof(float);
+
+    // Planes already evenly spaced can go out as they are, the NDI stride is an int so
+    // planes further apart than that (or out of order) are packed like any other layout
+    ptrdiff_t plane_distance = channels > 1 ? frame->extended_data[1] - frame->extended_data[0] : plane_size;
+
+    bool contiguous = plane_distance >= plane_size && plane_distance <= INT_MAX;
+    for (int c = 2; c < channels && contiguous; c++) {
+        contiguous = frame->extended_data[c] == frame->extended_data[0] + plane_distance * c;
+    }
+
+    if (contiguous) {
+        channel_stride = (int)plane_distance;
+        return frame->extended_data[0];
+    }
+
+    channel_stride = plane_size;
+    scratch.resize((size_t)plane_size * channels);
+    for (int c = 0; c < channels; c++) {
+        memcpy(scratch.data() + (size_t)plane_size * c, frame->extended_data[c], plane_size);
+    }
+
+    return scratch.data();
+}
+
+NV12Packer::~NV12Packer() {
+    FUNCTION_CALL_DEBUG();
+
+    // Buffers still in flight keep the pool alive until they are returned
+    av_buffer_pool_uninit(&_pool);
+}
+
+uint8_t *NV12Packer::Pack(const AVFrame *frame, AVBufferRef **buffer) {
+    FUNCTION_CALL_DEBUG();
+
+    *buffer = nullptr;
+
+    if (IsContiguousNV12(frame)) {
+        _zero_copy_frames.fetch_add(1, std::memory_order_relaxed);
+        return frame->data[0];
+    }
+
+#ifdef _DEBUG
+    // profile function
+    auto time_start = std::chrono::high_resolution_clock::now();
+#endif
+
+    const size_t stride = frame->linesize[0];
+    const size_t uv_height = (frame->height + 1) / 2;
+    const size_t y_size = stride * frame->height;
+    const size_t buffer_size = y_size + stride * uv_height;
+
+    // Resolution changes are rare, start a fresh pool when they happen
+    if (_pool == nullptr || _pool_buffer_size != buffer_size) {
+        av_buffer_pool_uninit(&_pool);
+
+        _pool = av_buffer_pool_init(buffer_size, nullptr);
+        if (_pool == nullptr) {
+            return nullptr;
+        }
+
+        _pool_buffer_size = buffer_size;
+    }
+
+    *buffer = av_buffer_pool_get(_pool);
+    if (*buffer == nullptr) {
+        return nullptr;
+    }
+
+    uint8_t *target_buffer = (*buffer)->data;
+
+    // Y keeps its stride, so it is always one copy
+    memcpy(target_buffer, frame->data[0], y_size);
+
+    // UV only needs restriding when the planes disagree
+    uint8_t *target_uv = target_buffer + y_size;
+    if ((size_t)frame->linesize[1] == stride) {
+        memcpy(target_uv, frame->data[1], stride * uv_height);
+    } else {
+        const size_t row_size = std::min<size_t>(stride, frame->linesize[1]);
+        for (size_t row = 0; row < uv_height; row++) {
+            memcpy(target_uv + row * stride, frame->data[1] + row * frame->linesize[1], row_size);
+        }
+    }
+
+    _packed_frames.fetch_add(1, std::memory_order_relaxed);
+
+#ifdef _DEBUG
+    // profile function
+    auto time_end = std::chrono::high_resolution_clock::now();
+    DEBUG("NV12 pack time (seconds): %f", std::chrono::duration<double>(time_end - time_start).count());
+#endif
+
+    return target_buffer;
+}
+
+NV12PackStats NV12Packer::GetStats() const {
+    return {_zero_copy_frames.load(std::memory_order_relaxed), _packed_frames.load(std::memory_order_relaxed)};
+}
+
+int64_t NDITimecode::Timecode(const AVFrame *frame) {
+    if (frame->pts == AV_NOPTS_VALUE || frame->time_base.num <= 0 || frame->time_base.den <= 0) {
+        return kSynthesize;
+    }
+
+    int64_t pts = av_rescale_q(frame->pts, frame->time_base, {1, 10000000});
+
+    int64_t offset = _offset.load(std::memory_order_acquire);
+    if (offset == INT64_MIN) {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        int64_t epoch = std::chrono::duration_cast<std::chrono::duration<int64_t, std::ratio<1, 10000000>>>(now).count();
+
+        // Audio and video race for the first frame, whichever wins anchors both
+        int64_t expected = INT64_MIN;
+        if (_offset.compare_exchange_strong(expected, epoch - pts, std::memory_order_acq_rel)) {
+            offset = epoch - pts;
+        } else {
+            offset = expected;
+        }
+    }
+
+    return offset + pts;
+}
+
 } // namespace AV::Utils
\ No newline at end of file
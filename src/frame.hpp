@@ -11,10 +11,41 @@
 // 3rd Party Dependencies
 extern "C" {
 #include <libavformat/avformat.h>
+#include <libavutil/buffer.h>
 }
 
+// Standard C++ Dependencies
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 namespace AV::Utils {
 
+/**
+ * @brief Frees an AVFrame and every reference it holds
+ */
+struct FrameDeleter {
+    void operator()(AVFrame *frame) const { av_frame_free(&frame); }
+};
+
+/**
+ * @brief Owning handle to an AVFrame. Frames are moved from stage to stage,
+ * so one decoded frame makes a single trip through the pipeline.
+ */
+using FramePtr = std::unique_ptr<AVFrame, FrameDeleter>;
+
+/**
+ * @brief Move the references out of a frame that its producer reuses
+ * (decoder, resampler, filter) into a frame of its own. No buffer is referenced
+ * again, the producer's frame is left blank.
+ *
+ * @param frame The reused frame
+ * @return FramePtr The new owner of the frame's buffers, null if allocation failed
+ */
+FramePtr TakeFrame(AVFrame *frame);
+
 /**
  * @brief Copy an AVFrame
  * @param frame The frame to copy
@@ -36,4 +67,97 @@ void PrintPictType(AVPictureType type);
 
 uint8_t *CombinePlanesNV12(const AVFrame *frame, uint planes);
 
+/**
+ * @brief Check if an NV12 frame already has the single buffer layout NDI expects,
+ * the UV plane directly following the Y plane with the same stride
+ *
+ * @param frame The NV12 frame
+ * @return bool True if the frame can be handed to NDI as is
+ */
+bool IsContiguousNV12(const AVFrame *frame);
+
+/**
+ * @brief Get float planar audio in the layout NDI expects, every channel
+ * the same distance apart in one block of memory
+ *
+ * Decoders and resamplers allocate their planes that way already, then the
+ * frame's own samples are returned. Otherwise the planes are packed into scratch,
+ * including planes in reverse order or further apart than an int stride can hold.
+ *
+ * @param frame The AV_SAMPLE_FMT_FLTP frame
+ * @param scratch Reused storage for frames that have to be packed
+ * @param channel_stride Receives the distance between channels in bytes
+ * @return uint8_t* The first sample of the first channel
+ */
+uint8_t *PackPlanarAudio(const AVFrame *frame, std::vector<uint8_t> &scratch, int &channel_stride);
+
+/**
+ * @brief How NV12 frames were handed to NDI
+ */
+typedef struct NV12PackStats {
+    uint64_t zero_copy_frames;
+    uint64_t packed_frames;
+} NV12PackStats;
+
+/**
+ * @brief Turns NV12 frames into the single buffer layout NDI expects.
+ *
+ * Contiguous frames are passed through untouched, everything else is copied into
+ * a buffer from an aligned pool that is recycled once the caller is done with it.
+ * Pack() is meant to be called from a single thread, GetStats() from anywhere.
+ */
+class NV12Packer {
+public:
+    NV12Packer() = default;
+    ~NV12Packer();
+
+    NV12Packer(const NV12Packer &) = delete;
+    NV12Packer &operator=(const NV12Packer &) = delete;
+
+    /**
+     * @brief Get a contiguous NV12 buffer for a frame
+     *
+     * @param frame The NV12 frame
+     * @param buffer Receives the pool buffer backing the result, nullptr if the frame was
+     * passed through. Release it with av_buffer_unref once the data has been sent.
+     * @return uint8_t* The NV12 data with a stride of linesize[0], nullptr on allocation failure
+     */
+    uint8_t *Pack(const AVFrame *frame, AVBufferRef **buffer);
+
+    NV12PackStats GetStats() const;
+
+private:
+    AVBufferPool *_pool = nullptr;
+    size_t _pool_buffer_size = 0;
+
+    std::atomic<uint64_t> _zero_copy_frames{0};
+    std::atomic<uint64_t> _packed_frames{0};
+};
+
+/**
+ * @brief Maps frame pts to NDI timecodes, 100 ns units since the Unix epoch.
+ *
+ * The first frame with a timestamp is pinned to the wall clock, every later frame,
+ * audio or video, is placed relative to it by its own pts. Receivers can then line
+ * audio up with video no matter how unevenly the frames arrive.
+ * Timecode() may be called from several threads at once.
+ */
+class NDITimecode {
+public:
+    // Same value as NDIlib_send_timecode_synthesize
+    static constexpr int64_t kSynthesize = INT64_MAX;
+
+    /**
+     * @brief Get the timecode for a frame
+     *
+     * @param frame A frame with pts and time_base set
+     * @return int64_t The timecode, kSynthesize if the frame has no timestamp
+     */
+    int64_t Timecode(const AVFrame *frame);
+
+private:
+    // Added to the pts in 100 ns units, INT64_MIN until the first frame sets it
+    std::atomic<int64_t> _offset{INT64_MIN};
+};
+
 } // namespace AV::Utils
\ No newline at end of file
@@ -0,0 +1,121 @@
+/**
+ * @file framepool.cpp
+ * @brief Pooled, NDI ready frame buffers for decoders
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include "framepool.hpp"
+#include "macro.hpp"
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <cstdint>
+
+namespace AV::Utils {
+
+FrameBufferPool::~FrameBufferPool() {
+    FUNCTION_CALL_DEBUG();
+
+    // Frames still in flight keep the pool alive until they are returned
+    av_buffer_pool_uninit(&_pool);
+}
+
+void FrameBufferPool::Attach(AVCodecContext *codec) {
+    FUNCTION_CALL_DEBUG();
+
+    codec->opaque = this;
+    codec->get_buffer2 = &FrameBufferPool::GetBuffer2;
+}
+
+int FrameBufferPool::GetBuffer(AVFrame *frame, int alloc_width, int alloc_height) {
+    FUNCTION_CALL_DEBUG();
+
+    AVPixelFormat pix_fmt = (AVPixelFormat)frame->format;
+
+    int linesizes[4] = {};
+    int ret = av_image_fill_linesizes(linesizes, pix_fmt, alloc_width);
+    if (ret < 0) {
+        return ret;
+    }
+
+    ptrdiff_t aligned_linesizes[4] = {};
+    for (int i = 0; i < 4; i++) {
+        aligned_linesizes[i] = (linesizes[i] + AVUTILS_FRAME_ALIGN - 1) & ~(AVUTILS_FRAME_ALIGN - 1);
+    }
+
+    size_t plane_sizes[4] = {};
+    ret = av_image_fill_plane_sizes(plane_sizes, pix_fmt, alloc_height, aligned_linesizes);
+    if (ret < 0) {
+        return ret;
+    }
+
+    // Room to align the start of the buffer and for decoders that read a little past the last plane
+    size_t buffer_size = AVUTILS_FRAME_ALIGN + AV_INPUT_BUFFER_PADDING_SIZE;
+    for (int i = 0; i < 4; i++) {
+        buffer_size += plane_sizes[i];
+    }
+
+    AVBufferRef *buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // Resolution changes are rare, start a fresh pool when they happen
+        if (_pool == nullptr || _pool_buffer_size != buffer_size) {
+            av_buffer_pool_uninit(&_pool);
+
+            _pool = av_buffer_pool_init(buffer_size, nullptr);
+            if (_pool == nullptr) {
+                return AVERROR(ENOMEM);
+            }
+
+            _pool_buffer_size = buffer_size;
+            DEBUG("Frame pool buffer size: %lu", buffer_size);
+        }
+
+        buffer = av_buffer_pool_get(_pool);
+    }
+
+    if (buffer == nullptr) {
+        return AVERROR(ENOMEM);
+    }
+
+    uint8_t *data = (uint8_t *)(((uintptr_t)buffer->data + AVUTILS_FRAME_ALIGN - 1) & ~(uintptr_t)(AVUTILS_FRAME_ALIGN - 1));
+
+    // Planes follow each other directly, every plane size is a multiple of the alignment
+    for (int i = 0; i < 4 && plane_sizes[i]; i++) {
+        frame->data[i] = data;
+        frame->linesize[i] = (int)aligned_linesizes[i];
+        data += plane_sizes[i];
+    }
+
+    frame->buf[0] = buffer;
+    frame->extended_data = frame->data;
+
+    return 0;
+}
+
+int FrameBufferPool::GetBuffer2(AVCodecContext *codec, AVFrame *frame, int flags) {
+    auto *pool = static_cast<FrameBufferPool *>(codec->opaque);
+
+    // Audio, hardware surfaces, palettes and decoders that can't take our buffers use libavcodec's allocator
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat)frame->format);
+    if (pool == nullptr || codec->codec_type != AVMEDIA_TYPE_VIDEO || !(codec->codec->capabilities & AV_CODEC_CAP_DR1) ||
+        desc == nullptr || (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL))) {
+        return avcodec_default_get_buffer2(codec, frame, flags);
+    }
+
+    // Decoders write whole macroblocks, so allocate the coded size they ask for
+    int width = frame->width;
+    int height = frame->height;
+    int linesize_align[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(codec, &width, &height, linesize_align);
+
+    return pool->GetBuffer(frame, width, height);
+}
+
+} // namespace AV::Utils
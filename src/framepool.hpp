@@ -0,0 +1,75 @@
+/**
+ * @file framepool.hpp
+ * @brief Pooled, NDI ready frame buffers for decoders
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#pragma once
+
+// 3rd Party Dependencies
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+}
+
+// Standard C++ Dependencies
+#include <cstddef>
+#include <mutex>
+
+// Linesizes and planes handed out by the pool start on this boundary
+#define AVUTILS_FRAME_ALIGN 64
+
+namespace AV::Utils {
+
+/**
+ * @brief Hands out frame buffers from an AVBufferPool.
+ *
+ * Every frame lives in a single buffer with its planes back to back, linesizes and
+ * planes 64 byte aligned. When a frame is allocated at its display height an NV12
+ * frame is already in the layout NDI expects and is sent without a copy. Buffers
+ * return to the pool once the last reference to the frame is dropped, so a steady
+ * stream of one resolution stops allocating after the first few frames.
+ *
+ * GetBuffer() may be called from several threads at once, frame threaded decoders do.
+ */
+class FrameBufferPool {
+public:
+    FrameBufferPool() = default;
+    ~FrameBufferPool();
+
+    FrameBufferPool(const FrameBufferPool &) = delete;
+    FrameBufferPool &operator=(const FrameBufferPool &) = delete;
+
+    /**
+     * @brief Make a decoder allocate its video frames from this pool,
+     * call before avcodec_open2
+     *
+     * @param codec The decoder context, its opaque field is taken over by the pool
+     */
+    void Attach(AVCodecContext *codec);
+
+    /**
+     * @brief Give a frame pooled buffers, format, width and height must be set
+     *
+     * @param frame The frame to fill in
+     * @param alloc_width Width to allocate, at least frame->width
+     * @param alloc_height Rows to allocate per plane, at least frame->height
+     * @return int 0 on success, a negative AVERROR otherwise
+     */
+    int GetBuffer(AVFrame *frame, int alloc_width, int alloc_height);
+
+    /**
+     * @brief get_buffer2 callback, the pool is read from codec->opaque
+     */
+    static int GetBuffer2(AVCodecContext *codec, AVFrame *frame, int flags);
+
+private:
+    std::mutex _mutex;
+    AVBufferPool *_pool = nullptr;
+    size_t _pool_buffer_size = 0;
+};
+
+} // namespace AV::Utils
@@ -10,8 +10,8 @@
 #include "frame.hpp"
 #include "macro.hpp"
 
-#include <algorithm>
 #include <chrono>
+#include <utility>
 
 namespace AV::Utils {
 
@@ -24,6 +24,10 @@ FrameTimer::FrameTimer(const int capacity) {
     FUNCTION_CALL_DEBUG();
 
     _capacity = capacity;
+
+    // Never reallocate on the hot path
+    _keys.reserve(capacity);
+    _frames.reserve(capacity);
 }
 
 /**
@@ -31,21 +35,16 @@ FrameTimer::FrameTimer(const int capacity) {
  */
 FrameTimer::~FrameTimer() {
     FUNCTION_CALL_DEBUG();
-
-    // Free all frames
-    for (auto frame : _frames) {
-        av_frame_free(&frame);
-    }
 }
 
 /**
  * @brief Add a frame to the FrameTimer
- * Keep in mind that a copy(referenced) of the frame is made.
+ * The FrameTimer takes ownership of the frame, on failure it is left with the caller.
  * 
  * @param frame The frame to add
  * @return AvException
  */
-AvException FrameTimer::AddFrame(AVFrame *frame) {
+AvException FrameTimer::AddFrame(FramePtr &&frame) {
     FUNCTION_CALL_DEBUG();
 
     if(_frames.size() >= _capacity) {
@@ -62,31 +61,33 @@ AvException FrameTimer::AddFrame(AVFrame *frame) {
         return AvError::INVALIDFRAME;
     }
 
-    // Copy the frame
-    AVFrame *new_frame = CopyFrame(frame);
-    if (!new_frame) {
-        return AvError::FRAMEALLOC;
-    }
+#ifdef _DEBUG
+    // profile function
+    auto time_start = std::chrono::high_resolution_clock::now();
+#endif
 
-    // Add the frame to the vector
-    _frames.push_back(new_frame);
+    // Force a universal time unit of microseconds, once per frame
+    _keys.push_back(av_rescale_q(frame->pts, frame->time_base, {1, 1000000}));
+    _frames.push_back(std::move(frame));
 
-    // Reorder frames
-    auto err = _ReorderFrames();
-    if (err != AvError::NOERROR) {
-        return err;
-    }
+    _SiftUp(_frames.size() - 1);
+
+#ifdef _DEBUG
+    // profile function
+    auto time_end = std::chrono::high_resolution_clock::now();
+    DEBUG("Frame insert time (seconds): %f", std::chrono::duration<double>(time_end - time_start).count());
+#endif
 
     return AvError::NOERROR;
 }
 
 /**
  * @brief Get the next frame in the sequence
- * This function will give you a copy of the frame and remove it from the FrameTimer
+ * Ownership of the frame moves to the caller
  * 
- * @return AVFrame* The next frame in the sequence
+ * @return FramePtr The next frame in the sequence, null if empty
  */
-AVFrame *FrameTimer::GetFrame() {
+FramePtr FrameTimer::GetFrame() {
     FUNCTION_CALL_DEBUG();
 
 #ifdef _DEBUG
@@ -98,10 +99,19 @@ AVFrame *FrameTimer::GetFrame() {
         return nullptr;
     }
 
-    // Pop a frame off
-    AVFrame *frame = _frames.back();
+    // The earliest frame is always at the root
+    FramePtr frame = std::move(_frames.front());
+
+    // Move the last leaf to the root and restore the heap
+    _keys.front() = _keys.back();
+    _frames.front() = std::move(_frames.back());
+    _keys.pop_back();
     _frames.pop_back();
 
+    if (!_frames.empty()) {
+        _SiftDown(0);
+    }
+
 #ifdef _DEBUG
     // profile function
     auto time_end = std::chrono::high_resolution_clock::now();
@@ -138,33 +148,61 @@ bool FrameTimer::IsHalf() {
 }
 
 /**
- * @brief This function will order the frame based on the
- * pts, time_base, and frame_rate.
+ * @brief Move the entry at index up until its parent is earlier
+ *
+ * @param index The index of the entry to move
  */
-AvError FrameTimer::_ReorderFrames() {
-    FUNCTION_CALL_DEBUG();
-
-#ifdef _DEBUG
-    // profile function
-    auto time_start = std::chrono::high_resolution_clock::now();
-#endif
-
-    // Sort the frames based on pts order
-    std::sort(_frames.begin(), _frames.end(), [](AVFrame *a, AVFrame *b) {
-        // Force a universal time unit of microseconds
-        auto apts = av_rescale_q(a->pts, a->time_base, {1, 1000000});
-        auto bpts = av_rescale_q(b->pts, b->time_base, {1, 1000000});
+void FrameTimer::_SiftUp(size_t index) {
+    int64_t key = _keys[index];
+    FramePtr frame = std::move(_frames[index]);
+
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (_keys[parent] <= key) {
+            break;
+        }
+
+        _keys[index] = _keys[parent];
+        _frames[index] = std::move(_frames[parent]);
+        index = parent;
+    }
 
-        return apts > bpts;
-    });
+    _keys[index] = key;
+    _frames[index] = std::move(frame);
+}
 
-#ifdef _DEBUG
-    // profile function
-    auto time_end = std::chrono::high_resolution_clock::now();
-    DEBUG("Frame reorder time (seconds): %f", std::chrono::duration<double>(time_end - time_start).count());
-#endif
+/**
+ * @brief Move the entry at index down until both children are later
+ *
+ * @param index The index of the entry to move
+ */
+void FrameTimer::_SiftDown(size_t index) {
+    const size_t size = _keys.size();
+    int64_t key = _keys[index];
+    FramePtr frame = std::move(_frames[index]);
+
+    while (true) {
+        size_t child = index * 2 + 1;
+        if (child >= size) {
+            break;
+        }
+
+        // Pick the earlier of the two children
+        if (child + 1 < size && _keys[child + 1] < _keys[child]) {
+            child++;
+        }
+
+        if (key <= _keys[child]) {
+            break;
+        }
+
+        _keys[index] = _keys[child];
+        _frames[index] = std::move(_frames[child]);
+        index = child;
+    }
 
-    return AvError::NOERROR;
+    _keys[index] = key;
+    _frames[index] = std::move(frame);
 }
 
 } // namespace AV::Utils
\ No newline at end of file
@@ -10,6 +10,7 @@
 
 // Local includes
 #include "averror.hpp"
+#include "frame.hpp"
 
 // 3rd Party Dependencies
 extern "C" {
@@ -17,6 +18,7 @@ extern "C" {
 }
 
 // Standard C++ Dependencies
+#include <cstdint>
 #include <vector>
 
 // Defines
@@ -35,6 +37,10 @@ extern "C" {
  * An easy way to predict the next PTS is to use the formula:
  * Video: pts = last_pts + (1 / frame_rate)
  * Audio: pts = last_pts + (1 / sample_rate)
+ *
+ * Frames are kept in a binary min-heap. The pts of every frame is rescaled to
+ * microseconds once on insert and stored in a flat key array that mirrors the
+ * frame array, so inserting and popping are O(log n) integer compares.
  */
 
 namespace AV::Utils {
@@ -46,17 +52,17 @@ public:
 
     /**
      * @brief Add a frame to the FrameTimer
-     * Keep in mind that a copy(referenced) of the frame is made.
+     * The FrameTimer takes ownership of the frame, on failure it is left with the caller.
      * @param frame The frame to add
      */
-    AvException AddFrame(AVFrame *frame);
+    AvException AddFrame(FramePtr &&frame);
     
     /**
      * @brief Get the next frame in the sequence
-     * This function will give you a copy of the frame and remove it from the FrameTimer
-     * @return AVFrame* The next frame in the sequence
+     * Ownership of the frame moves to the caller
+     * @return FramePtr The next frame in the sequence, null if empty
      */
-    AVFrame *GetFrame();
+    FramePtr GetFrame();
 
     /**
      * @brief Check if the FrameTimer is full
@@ -68,9 +74,12 @@ public:
     bool IsHalf();
 
 private:
-    AvError _ReorderFrames();
+    void _SiftUp(size_t index);
+    void _SiftDown(size_t index);
 
-    std::vector<AVFrame *> _frames;
+    // _keys[i] is the pts of _frames[i] in microseconds
+    std::vector<int64_t> _keys;
+    std::vector<FramePtr> _frames;
     int _capacity;
 };
 
@@ -11,6 +11,7 @@
 
 namespace AV::Utils {
     int NDI::m_open_instances = 0;
+    std::mutex NDI::m_mutex;
 
     /**
      * @brief Construct a new NDI object
@@ -18,6 +19,8 @@ namespace AV::Utils {
     NDI::NDI() {
         FUNCTION_CALL_DEBUG();
 
+        std::lock_guard<std::mutex> lock(m_mutex);
+
         if(!m_open_instances) {
             DEBUG("NDI library has not been initialized yet, initializing now");
             NDIlib_initialize();
@@ -32,6 +35,8 @@ namespace AV::Utils {
     NDI::~NDI() {
         FUNCTION_CALL_DEBUG();
 
+        std::lock_guard<std::mutex> lock(m_mutex);
+
         m_open_instances--;
 
         if(!m_open_instances) {
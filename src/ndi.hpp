@@ -9,6 +9,7 @@
 
 // Standard includes
 #include <cstdlib> // Needed for NDI SDK
+#include <mutex>
 #include <string>
 
 // NDI SDK
@@ -18,7 +19,8 @@ namespace AV::Utils {
 
 /**
  * @brief This class just makes sure that the NDI library is initialized and deinitialized properly.
- * Attach this to anything that uses the NDI SDK.
+ * Attach this to anything that uses the NDI SDK. Sources of several channels are created and
+ * destroyed on different threads, so the count is guarded.
  */
 class NDI {
 public:
@@ -34,6 +36,7 @@ public:
 
 private:
     static int m_open_instances;
+    static std::mutex m_mutex;
 };
 
 } // namespace AV::Utils
\ No newline at end of file
@@ -85,7 +85,8 @@ AvError NDISource::_SendVideoFrame(const AVFrame *frame) {
 #endif
 
 
-    bool manual_free = false;
+    // Pool buffer backing the frame when NV12 planes had to be packed
+    AVBufferRef *packed_buffer = nullptr;
 
     // Build NDI packet from frame
     NDIlib_video_frame_v2_t video_frame;
@@ -120,8 +121,10 @@ AvError NDISource::_SendVideoFrame(const AVFrame *frame) {
         DEBUG("data[1]: %p", frame->data[1]);
         DEBUG("data[1] - data[0]: %ld | Frame 0 Size: %d", frame->data[1] - frame->data[0], frame->linesize[0] * frame->height);
 
-        video_frame.p_data = CombinePlanesNV12(frame, 2);
-        manual_free = true;
+        video_frame.p_data = _nv12_packer.Pack(frame, &packed_buffer);
+        if(video_frame.p_data == nullptr) {
+            return AvError::AVMALLOC;
+        }
 
         break;
     default:
@@ -132,15 +135,13 @@ AvError NDISource::_SendVideoFrame(const AVFrame *frame) {
     video_frame.yres = frame->height;
     video_frame.frame_rate_N = _frame_rate.num;
     video_frame.frame_rate_D = _frame_rate.den;
-    video_frame.timecode = NDIlib_send_timecode_synthesize;
+    video_frame.timecode = _timecode.Timecode(frame);
     video_frame.frame_format_type = NDIlib_frame_format_type_progressive;
 
     // Send the frame
     NDIlib_send_send_video_v2(_ndi_send_instance, &video_frame);
 
-    if(manual_free) {
-        delete[] video_frame.p_data;
-    }
+    av_buffer_unref(&packed_buffer);
 
 #ifdef _DEBUG
     // profile function
@@ -152,26 +153,44 @@ AvError NDISource::_SendVideoFrame(const AVFrame *frame) {
 }
 
 /**
- * Only send audio frames that are interleaved 16-bit signed PCM.
+ * Send audio frames that are planar 32-bit float (NDI's native format, sent as is)
+ * or interleaved 16-bit signed PCM.
  */
 AvError NDISource::_SendAudioFrame(const AVFrame *frame) {
     FUNCTION_CALL_DEBUG();
 
-    if(frame->format != AV_SAMPLE_FMT_S16) {
+    switch(frame->format) {
+    case AV_SAMPLE_FMT_FLTP: {
+        // NDI's native format, the samples go out without a conversion
+        NDIlib_audio_frame_v3_t audio_frame;
+
+        audio_frame.sample_rate = frame->sample_rate;
+        audio_frame.no_channels = frame->ch_layout.nb_channels;
+        audio_frame.no_samples = frame->nb_samples;
+        audio_frame.timecode = _timecode.Timecode(frame);
+        audio_frame.FourCC = NDIlib_FourCC_audio_type_FLTP;
+        audio_frame.p_data = PackPlanarAudio(frame, _audio_scratch, audio_frame.channel_stride_in_bytes);
+
+        NDIlib_send_send_audio_v3(_ndi_send_instance, &audio_frame);
+        break;
+    }
+    case AV_SAMPLE_FMT_S16: {
+        // Build NDI packet from frame
+        NDIlib_audio_frame_interleaved_16s_t audio_frame;
+
+        audio_frame.sample_rate = frame->sample_rate;
+        audio_frame.no_channels = frame->ch_layout.nb_channels;
+        audio_frame.no_samples = frame->nb_samples;
+        audio_frame.timecode = _timecode.Timecode(frame);
+        audio_frame.p_data = (int16_t *)frame->data[0];
+
+        // Send the frame, the SDK converts it to float planar
+        NDIlib_util_send_send_audio_interleaved_16s(_ndi_send_instance, &audio_frame);
+        break;
+    }
+    default:
         return AvError::INVALIDSMPLFMT;
     }
-    
-    // Build NDI packet from frame
-    NDIlib_audio_frame_interleaved_16s_t audio_frame;
-
-    audio_frame.sample_rate = frame->sample_rate;
-    audio_frame.no_channels = frame->ch_layout.nb_channels;
-    audio_frame.no_samples = frame->nb_samples;
-    audio_frame.timecode = NDIlib_send_timecode_synthesize;
-    audio_frame.p_data = (int16_t *)frame->data[0];
-
-    // Send the frame
-    NDIlib_util_send_send_audio_interleaved_16s(_ndi_send_instance, &audio_frame);
 
     return AvError::NOERROR;
 }
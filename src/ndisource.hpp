@@ -10,6 +10,7 @@
 
 // Local includes
 #include "ndi.hpp"
+#include "frame.hpp"
 #include "averror.hpp"
 
 // NDI SDK
@@ -23,6 +24,7 @@ extern "C" {
 // Standard C++ includes
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace AV::Utils {
 
@@ -45,10 +47,18 @@ public:
 
     AvException SendFrame(const AVFrame *frame);
 
+    // How many NV12 frames went out zero copy and how many had to be packed
+    NV12PackStats GetNV12Stats() const { return _nv12_packer.GetStats(); }
+
 private:
     std::string _source_name;
     NDIlib_send_instance_t _ndi_send_instance = nullptr;
     AVRational _frame_rate;
+    NV12Packer _nv12_packer;
+    NDITimecode _timecode;
+
+    // Float planar audio that has to be packed before sending
+    std::vector<uint8_t> _audio_scratch;
 
 };
 
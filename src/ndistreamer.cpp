@@ -7,11 +7,19 @@
  */
 
 // Standard library
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <thread>
+#include <vector>
 
 // POSIX includes
+#include <getopt.h>
 #include <unistd.h>
 
 // Local includes
@@ -20,60 +28,469 @@
 #include "vaapiapp.hpp"
 #include "cudaapp.hpp"
 #include "app.hpp"
+#include "ndi.hpp"
+#include "threadpool.hpp"
 
 typedef struct CommandLineArguments {
-    std::string videofile;
-    std::string ndisource;
+    std::vector<std::string> videofiles;
+    std::vector<AV::Utils::NDIOutputConfig> ndioutputs;
     std::string hwtype;
+    size_t workerthreads;
+    AV::Utils::DecoderConfig decoderconfig;
+    bool syncvideo;
+    bool loop;
+    std::string cachedir;
+    bool buildcache;
+    std::string channelfile;
+    int priority;
+    AV::Utils::DemuxerConfig demuxerconfig;
+    AV::Utils::PacketQueueConfig packetqueueconfig;
+    bool packuyvy;
 
-    CommandLineArguments() : videofile(""), ndisource("NDI Source"), hwtype("software") {}
+    CommandLineArguments() : hwtype("software"), workerthreads(0), syncvideo(false), loop(false), buildcache(false), priority(0), packuyvy(false) {}
 } COMMANDLINEARGUMENTS, *PCOMMANDLINEARGUMENTS;
 
 void Usage(const char *const argv0) {
     printf("\n%s\n"
-           "\t-i /path/to/media.mp4\n"
-           "\t-s \"NDI Source Name\"\n"
-           "\t-t [software, cuda, vaapi]\n\n",
+           "\t-i /path/to/media.mp4, repeat to play several files back to back\n"
+           "\t-p /path/to/playlist.txt, one media file per line\n"
+           "\t-s \"NDI Source Name\"[@WIDTHxHEIGHT], repeat to send one decode to several sources\n"
+           "\t-t [software, cuda, vaapi]\n"
+           "\t-j worker threads for pixel conversion (0 = all cores)\n"
+           "\t-d decoder threading [frame, slice, both, none][:count] (count 0 = auto)\n"
+           "\t-c channels sharing this host, auto decoder threading divides the cores between them\n"
+           "\t-S send video to NDI synchronously instead of overlapping it with the next frame\n"
+           "\t--loop start over at the end, a single file is seeked in place\n"
+           "\t--cache /path/to/cache, play from pre-decoded caches, the first playout of a file records one\n"
+           "\t--build-cache record the caches of every file and exit, nothing is sent (requires --cache)\n"
+           "\t--channels /path/to/channels.txt, run every channel of the list in this process\n"
+           "\t--priority channels of higher priority get the shared worker pool first (default 0)\n"
+           "\t--mmap read local media files through a memory mapping\n"
+           "\t--readahead milliseconds of packets demuxed ahead of each decoder (default 2000)\n"
+           "\t--probesize bytes read to find the streams of a file (default libavformat's)\n"
+           "\t--analyzeduration milliseconds of media decoded to find stream parameters (default libavformat's)\n"
+           "\t--probe-cache /path/to/cache, reopen known files from their cached stream info instead of probing\n"
+           "\t--uyvy pack cuda/vaapi decodes into UYVY on the CPU instead of sending NV12 (implied by --cache)\n\n",
            argv0);
 }
 
+// Parse decoder threading, type[:count]
+ERRORTYPE ParseDecoderThreading(AV::Utils::DecoderConfig &config, const std::string &arg) {
+    std::string type = arg.substr(0, arg.find(':'));
+
+    if (type == "frame") {
+        config.thread_type = AV::Utils::DecoderThreadType::FRAME;
+    } else if (type == "slice") {
+        config.thread_type = AV::Utils::DecoderThreadType::SLICE;
+    } else if (type == "both") {
+        config.thread_type = AV::Utils::DecoderThreadType::BOTH;
+    } else if (type == "none") {
+        config.thread_type = AV::Utils::DecoderThreadType::NONE;
+    } else {
+        return FAILED;
+    }
+
+    if (arg.find(':') != std::string::npos) {
+        config.thread_count = atoi(arg.c_str() + arg.find(':') + 1);
+    }
+
+    return SUCCESSFUL;
+}
+
+// Parse an NDI output, name[@WIDTHxHEIGHT]
+ERRORTYPE ParseNDIOutput(AV::Utils::NDIOutputConfig &output, const std::string &arg) {
+    size_t at = arg.rfind('@');
+    output.name = arg.substr(0, at);
+
+    if (at != std::string::npos) {
+        if (sscanf(arg.c_str() + at + 1, "%dx%d", &output.width, &output.height) != 2 || output.width <= 0 || output.height <= 0) {
+            return FAILED;
+        }
+    }
+
+    return output.name.empty() ? FAILED : SUCCESSFUL;
+}
+
+// Read a playlist, one path per line. Blank lines and lines starting with # are skipped.
+ERRORTYPE ReadPlaylist(std::vector<std::string> &videofiles, const std::string &path) {
+    std::ifstream playlist(path);
+    if (!playlist.is_open()) {
+        return FAILED;
+    }
+
+    std::string line;
+    while (std::getline(playlist, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        videofiles.push_back(line);
+    }
+
+    return SUCCESSFUL;
+}
+
+// Split a channel line into arguments, double quotes keep spaces in one argument
+std::vector<std::string> SplitArguments(const std::string &line) {
+    std::vector<std::string> args;
+    std::string arg;
+    bool quoted = false, in_arg = false;
+
+    for (char c : line) {
+        if (c == '"') {
+            quoted = !quoted;
+            in_arg = true;
+        } else if (!quoted && isspace((unsigned char)c)) {
+            if (in_arg) {
+                args.push_back(arg);
+                arg.clear();
+                in_arg = false;
+            }
+        } else {
+            arg += c;
+            in_arg = true;
+        }
+    }
+
+    if (in_arg) {
+        args.push_back(arg);
+    }
+
+    return args;
+}
+
+ERRORTYPE ParseCommandLineArguments(COMMANDLINEARGUMENTS &cmdlineargs, int argc, char **argv);
+
+// Read a channel list, one channel per line in command line syntax. Options given on the
+// command line are the defaults of every channel. Blank lines and lines starting with # are skipped.
+ERRORTYPE ReadChannels(std::vector<COMMANDLINEARGUMENTS> &channels, const COMMANDLINEARGUMENTS &defaults, const std::string &path) {
+    std::ifstream channellist(path);
+    if (!channellist.is_open()) {
+        ERROR("Failed to read channel list %s", path.c_str());
+        return FAILED;
+    }
+
+    std::string line;
+    for (size_t lineno = 1; std::getline(channellist, line); lineno++) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+
+        std::vector<std::string> args = SplitArguments(line);
+        if (args.empty() || args[0][0] == '#') {
+            continue;
+        }
+
+        std::vector<char *> argv = {(char *)"channel"};
+        for (auto &arg : args) {
+            argv.push_back(arg.data());
+        }
+        argv.push_back(nullptr);
+
+        COMMANDLINEARGUMENTS channel = defaults;
+        channel.videofiles.clear();
+        channel.ndioutputs.clear();
+        channel.channelfile.clear();
+
+        if (!ParseCommandLineArguments(channel, (int)argv.size() - 1, argv.data()) || !channel.channelfile.empty()) {
+            ERROR("Invalid channel on line %lu of %s", lineno, path.c_str());
+            return FAILED;
+        }
+
+        // Every channel needs a source name of its own
+        if (channel.ndioutputs.empty()) {
+            channel.ndioutputs.push_back({"NDI Channel " + std::to_string(channels.size() + 1)});
+        }
+
+        channels.push_back(channel);
+    }
+
+    return SUCCESSFUL;
+}
+
 // Process command line arguments
 ERRORTYPE ParseCommandLineArguments(COMMANDLINEARGUMENTS &cmdlineargs, int argc, char **argv) {
 
+    static const struct option long_options[] = {
+        {"loop", no_argument, nullptr, 'l'},
+        {"cache", required_argument, nullptr, 'C'},
+        {"build-cache", no_argument, nullptr, 'B'},
+        {"channels", required_argument, nullptr, 'L'},
+        {"priority", required_argument, nullptr, 'P'},
+        {"mmap", no_argument, nullptr, 'M'},
+        {"readahead", required_argument, nullptr, 'R'},
+        {"probesize", required_argument, nullptr, 'Z'},
+        {"analyzeduration", required_argument, nullptr, 'A'},
+        {"probe-cache", required_argument, nullptr, 'I'},
+        {"uyvy", no_argument, nullptr, 'U'},
+        {nullptr, 0, nullptr, 0},
+    };
+
+    // Channel lines are parsed after the command line, start getopt over
+    optind = 0;
+
     int opt = 0;
-    while ((opt = getopt(argc, argv, "i:s:t:")) != -1) {
+    while ((opt = getopt_long(argc, argv, "i:p:s:t:j:d:c:S", long_options, nullptr)) != -1) {
         switch (opt) {
         case 'i':
-            cmdlineargs.videofile = optarg;
+            cmdlineargs.videofiles.push_back(optarg);
             break;
-        case 's':
-            cmdlineargs.ndisource = optarg;
+        case 'p':
+            if (!ReadPlaylist(cmdlineargs.videofiles, optarg)) {
+                ERROR("Failed to read playlist %s", optarg);
+                return FAILED;
+            }
             break;
+        case 's': {
+            AV::Utils::NDIOutputConfig output;
+            if (!ParseNDIOutput(output, optarg)) {
+                ERROR("Invalid NDI source");
+                return FAILED;
+            }
+
+            cmdlineargs.ndioutputs.push_back(output);
+            break;
+        }
         case 't':
             cmdlineargs.hwtype = optarg;
             break;
+        case 'j': {
+            // strtoul would wrap "-1" into a huge thread count
+            char *end = nullptr;
+            long long workerthreads = strtoll(optarg, &end, 10);
+            if (end == optarg || *end != '\0' || workerthreads < 0) {
+                ERROR("Invalid worker threads");
+                return FAILED;
+            }
+
+            cmdlineargs.workerthreads = (size_t)workerthreads;
+            break;
+        }
+        case 'd':
+            if (!ParseDecoderThreading(cmdlineargs.decoderconfig, optarg)) {
+                ERROR("Invalid decoder threading");
+                return FAILED;
+            }
+            break;
+        case 'c':
+            cmdlineargs.decoderconfig.channels = atoi(optarg);
+            break;
+        case 'S':
+            cmdlineargs.syncvideo = true;
+            break;
+        case 'l':
+            cmdlineargs.loop = true;
+            break;
+        case 'C':
+            cmdlineargs.cachedir = optarg;
+            break;
+        case 'B':
+            cmdlineargs.buildcache = true;
+            break;
+        case 'L':
+            cmdlineargs.channelfile = optarg;
+            break;
+        case 'P':
+            cmdlineargs.priority = atoi(optarg);
+            break;
+        case 'M':
+            cmdlineargs.demuxerconfig.memory_map = true;
+            break;
+        case 'R':
+            cmdlineargs.packetqueueconfig.max_duration_us = strtoll(optarg, nullptr, 10) * 1000;
+            if (cmdlineargs.packetqueueconfig.max_duration_us <= 0) {
+                ERROR("Invalid read-ahead");
+                return FAILED;
+            }
+            break;
+        case 'Z':
+            cmdlineargs.demuxerconfig.probesize = strtoll(optarg, nullptr, 10);
+            if (cmdlineargs.demuxerconfig.probesize <= 0) {
+                ERROR("Invalid probe size");
+                return FAILED;
+            }
+            break;
+        case 'A':
+            cmdlineargs.demuxerconfig.analyze_duration_us = strtoll(optarg, nullptr, 10) * 1000;
+            if (cmdlineargs.demuxerconfig.analyze_duration_us <= 0) {
+                ERROR("Invalid analyze duration");
+                return FAILED;
+            }
+            break;
+        case 'I':
+            cmdlineargs.demuxerconfig.stream_info_cache_dir = optarg;
+            break;
+        case 'U':
+            cmdlineargs.packuyvy = true;
+            break;
         default:
             return FAILED;
         }
     }
 
-    DEBUG("Video file --> %s", cmdlineargs.videofile.c_str());
-    DEBUG("NDI Source --> %s", cmdlineargs.ndisource.c_str());
+#ifdef _DEBUG
+    for (const auto &videofile : cmdlineargs.videofiles) {
+        DEBUG("Video file --> %s", videofile.c_str());
+    }
+    for (const auto &output : cmdlineargs.ndioutputs) {
+        DEBUG("NDI Source --> %s %dx%d", output.name.c_str(), output.width, output.height);
+    }
+#endif
     DEBUG("HW Type --> %s", cmdlineargs.hwtype.c_str());
+    DEBUG("Worker Threads --> %lu", cmdlineargs.workerthreads);
+    DEBUG("Sync Video --> %d", cmdlineargs.syncvideo);
+    DEBUG("Loop --> %d", cmdlineargs.loop);
+    DEBUG("Cache --> %s build %d", cmdlineargs.cachedir.c_str(), cmdlineargs.buildcache);
+    DEBUG("Channels --> %s priority %d", cmdlineargs.channelfile.c_str(), cmdlineargs.priority);
+    DEBUG("Memory Map --> %d", cmdlineargs.demuxerconfig.memory_map);
+    DEBUG("Read-ahead --> %ld us", cmdlineargs.packetqueueconfig.max_duration_us);
+    DEBUG("Pack UYVY --> %d", cmdlineargs.packuyvy);
+    DEBUG("Probe --> %ld bytes %ld us cache %s", cmdlineargs.demuxerconfig.probesize, cmdlineargs.demuxerconfig.analyze_duration_us, cmdlineargs.demuxerconfig.stream_info_cache_dir.c_str());
+    DEBUG("Decoder Threads --> type %d count %d channels %d", (int)cmdlineargs.decoderconfig.thread_type, cmdlineargs.decoderconfig.thread_count, cmdlineargs.decoderconfig.channels);
 
-    if (cmdlineargs.videofile == "") {
+    // A channel list brings its own files
+    if (!cmdlineargs.channelfile.empty()) {
+        if (!cmdlineargs.videofiles.empty()) {
+            ERROR("media files go in the channel list");
+            return FAILED;
+        }
+    } else if (cmdlineargs.videofiles.empty()) {
         ERROR("videofile required");
         return FAILED;
     }
 
+    if (cmdlineargs.buildcache && cmdlineargs.cachedir.empty()) {
+        ERROR("--build-cache requires --cache");
+        return FAILED;
+    }
+
     if(cmdlineargs.hwtype != "software" && cmdlineargs.hwtype != "cuda" && cmdlineargs.hwtype != "vaapi") {
         ERROR("Invalid HW type");
         return FAILED;
     }
 
+    // Caches hold UYVY, hardware decodes recorded into one have to be packed
+    if (!cmdlineargs.cachedir.empty()) {
+        cmdlineargs.packuyvy = true;
+    }
+
     return SUCCESSFUL;
 }
 
+// Print what a channel plays and where it sends to
+void PrintChannel(const COMMANDLINEARGUMENTS &cmdlineargs) {
+    for (const auto &output : cmdlineargs.ndioutputs) {
+        if (output.width > 0) {
+            PRINT("NDI Source: %s (%dx%d)", output.name.c_str(), output.width, output.height);
+        } else {
+            PRINT("NDI Source: %s", output.name.c_str());
+        }
+    }
+    for (const auto &videofile : cmdlineargs.videofiles) {
+        PRINT("Video File: %s", videofile.c_str());
+    }
+    PRINT("HW Type: %s", cmdlineargs.hwtype.c_str());
+}
+
+AV::Utils::PipelineConfig MakePipelineConfig(const COMMANDLINEARGUMENTS &cmdlineargs) {
+    AV::Utils::PipelineConfig config;
+    config.ndi_outputs = cmdlineargs.ndioutputs;
+    config.video_file_paths = cmdlineargs.videofiles;
+    config.worker_threads = cmdlineargs.workerthreads;
+    config.demuxer_config = cmdlineargs.demuxerconfig;
+    config.decoder_config = cmdlineargs.decoderconfig;
+    config.packet_queue_config = cmdlineargs.packetqueueconfig;
+    config.async_video_send = !cmdlineargs.syncvideo;
+    config.loop = cmdlineargs.loop;
+    config.cache_dir = cmdlineargs.cachedir;
+    config.build_cache_only = cmdlineargs.buildcache;
+    config.priority = cmdlineargs.priority;
+    config.pack_uyvy = cmdlineargs.packuyvy;
+
+    return config;
+}
+
+// Create the application for a hardware type
+AV::Utils::AvException CreateApp(std::shared_ptr<App> &app, const std::string &hwtype, const AV::Utils::PipelineConfig &config) {
+    AV::Utils::AvException err;
+
+    if(hwtype == "software") {
+        std::tie(app, err) = SoftwareApp::Create(config);
+    } else if(hwtype == "vaapi") {
+        std::tie(app, err) = VAAPIApp::Create(config);
+    } else if(hwtype == "cuda") {
+        std::tie(app, err) = CudaApp::Create(config);
+    }
+
+    return err;
+}
+
+// Run every channel of a channel list in this process, a failing channel leaves the others running
+int RunChannels(const COMMANDLINEARGUMENTS &cmdlineargs) {
+    std::vector<COMMANDLINEARGUMENTS> channels;
+    if (!ReadChannels(channels, cmdlineargs, cmdlineargs.channelfile)) {
+        return EXIT_FAILURE;
+    }
+
+    if (channels.empty()) {
+        ERROR("No channels in %s", cmdlineargs.channelfile.c_str());
+        return EXIT_FAILURE;
+    }
+
+    // One NDI library init and one worker pool sized to the host for every channel
+    AV::Utils::NDI ndi;
+    auto worker_pool = std::make_shared<AV::Utils::ThreadPool>(cmdlineargs.workerthreads);
+
+    std::atomic<int> failed_channels = 0;
+    std::vector<std::shared_ptr<App>> apps;
+    std::vector<size_t> channel_numbers;
+    for (size_t i = 0; i < channels.size(); i++) {
+        PRINT("Channel %lu (priority %d)", i + 1, channels[i].priority);
+        PrintChannel(channels[i]);
+
+        AV::Utils::PipelineConfig config = MakePipelineConfig(channels[i]);
+        config.worker_pool = worker_pool;
+
+        // Auto decoder threading divides the cores between every channel of the process
+        config.decoder_config.channels = std::max(config.decoder_config.channels, (int)channels.size());
+
+        std::shared_ptr<App> app(nullptr);
+        auto err = CreateApp(app, channels[i].hwtype, config);
+        if (err.code()) {
+            ERROR("Error creating channel %lu: %s", i + 1, err.what());
+            failed_channels++;
+            continue;
+        }
+
+        apps.push_back(app);
+        channel_numbers.push_back(i + 1);
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < apps.size(); i++) {
+        threads.emplace_back([&apps, &channel_numbers, &failed_channels, i] {
+            auto err = apps[i]->Run();
+            if (err.code()) {
+                ERROR("Error running channel %lu: %s", channel_numbers[i], err.what());
+                failed_channels++;
+            }
+        });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+
+    return failed_channels ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 int main(int argc, char **argv) {
     COMMANDLINEARGUMENTS cmdlineargs;
 
@@ -84,22 +501,21 @@ int main(int argc, char **argv) {
     }
 
     PRINT("NDI Streamer");
-    PRINT("NDI Source: %s", cmdlineargs.ndisource.c_str());
-    PRINT("Video File: %s", cmdlineargs.videofile.c_str());
-    PRINT("HW Type: %s", cmdlineargs.hwtype.c_str());
 
-    std::shared_ptr<App> app(nullptr);
-    AV::Utils::AvException err;
+    if (!cmdlineargs.channelfile.empty()) {
+        return RunChannels(cmdlineargs);
+    }
 
-    // Create the application
-    if(cmdlineargs.hwtype == "software") {
-        std::tie(app, err) = SoftwareApp::Create(cmdlineargs.ndisource, cmdlineargs.videofile);
-    } else if(cmdlineargs.hwtype == "vaapi") {
-        std::tie(app, err) = VAAPIApp::Create(cmdlineargs.ndisource, cmdlineargs.videofile);
-    } else if(cmdlineargs.hwtype == "cuda") {
-        std::tie(app, err) = CudaApp::Create(cmdlineargs.ndisource, cmdlineargs.videofile);
+    if (cmdlineargs.ndioutputs.empty()) {
+        cmdlineargs.ndioutputs.push_back({"NDI Source"});
     }
 
+    PrintChannel(cmdlineargs);
+
+    std::shared_ptr<App> app(nullptr);
+
+    // Create the application
+    auto err = CreateApp(app, cmdlineargs.hwtype, MakePipelineConfig(cmdlineargs));
     if (err.code()) {
         FATAL("Error creating application: %s", err.what());
     }
@@ -0,0 +1,181 @@
+/**
+ * @file packetqueue.cpp
+ * @brief Demux read-ahead queue bounded by bytes and duration, and a pool of packets to fill it
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include "packetqueue.hpp"
+#include "macro.hpp"
+
+extern "C" {
+#include <libavutil/mathematics.h>
+}
+
+// Empty packets kept around for reuse, more than this are freed
+#define PACKETPOOL_MAX_FREE 256
+
+namespace AV::Utils {
+
+int64_t PacketQueue::_Duration(const AVPacket *packet) {
+    if (packet == nullptr || packet->duration <= 0 || packet->time_base.num <= 0 || packet->time_base.den <= 0) {
+        return 0;
+    }
+
+    return av_rescale_q(packet->duration, packet->time_base, {1, 1000000});
+}
+
+bool PacketQueue::_Full() const {
+    if (_queue.empty()) {
+        return false;
+    }
+
+    return _queue.size() >= _config.max_packets || _bytes >= _config.max_bytes || _duration_us >= _config.max_duration_us;
+}
+
+void PacketQueue::_Remove(AVPacket *&packet) {
+    packet = _queue.front();
+    _queue.pop_front();
+
+    if (packet != nullptr) {
+        _bytes -= packet->size;
+        _duration_us -= _Duration(packet);
+    }
+}
+
+bool PacketQueue::Push(AVPacket *packet) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _not_full.wait(lock, [this] { return !_Full() || _closed || _aborted; });
+
+    if (_closed || _aborted) {
+        return false;
+    }
+
+    _queue.push_back(packet);
+    if (packet != nullptr) {
+        _bytes += packet->size;
+        _duration_us += _Duration(packet);
+    }
+    lock.unlock();
+
+    _not_empty.notify_one();
+    return true;
+}
+
+bool PacketQueue::Pop(AVPacket *&packet) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _not_empty.wait(lock, [this] { return !_queue.empty() || _closed || _aborted; });
+
+    if (_aborted || _queue.empty()) {
+        return false;
+    }
+
+    _Remove(packet);
+    lock.unlock();
+
+    _not_full.notify_one();
+    return true;
+}
+
+bool PacketQueue::TryPop(AVPacket *&packet) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_queue.empty()) {
+        return false;
+    }
+
+    _Remove(packet);
+    lock.unlock();
+
+    _not_full.notify_one();
+    return true;
+}
+
+void PacketQueue::Close() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _closed = true;
+    lock.unlock();
+
+    _not_empty.notify_all();
+    _not_full.notify_all();
+}
+
+void PacketQueue::Abort() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _aborted = true;
+    lock.unlock();
+
+    _not_empty.notify_all();
+    _not_full.notify_all();
+}
+
+size_t PacketQueue::Size() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _queue.size();
+}
+
+size_t PacketQueue::GetBytes() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _bytes;
+}
+
+int64_t PacketQueue::GetDurationUs() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _duration_us;
+}
+
+PacketPool::~PacketPool() {
+    FUNCTION_CALL_DEBUG();
+
+    for (AVPacket *packet : _free) {
+        av_packet_free(&packet);
+    }
+}
+
+AVPacket *PacketPool::Ref(const AVPacket *src) {
+    AVPacket *packet = nullptr;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_free.empty()) {
+        packet = _free.back();
+        _free.pop_back();
+    }
+    lock.unlock();
+
+    if (packet == nullptr) {
+        packet = av_packet_alloc();
+        if (packet == nullptr) {
+            return nullptr;
+        }
+    }
+
+    int ret = av_packet_ref(packet, src);
+    if (ret < 0) {
+        PRINT_FFMPEG_ERR(ret);
+        av_packet_free(&packet);
+        return nullptr;
+    }
+
+    return packet;
+}
+
+void PacketPool::Release(AVPacket *&packet) {
+    if (packet == nullptr) {
+        return;
+    }
+
+    // The payload goes back to the demuxer now, only the struct is kept
+    av_packet_unref(packet);
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (_free.size() < PACKETPOOL_MAX_FREE) {
+        _free.push_back(packet);
+        packet = nullptr;
+        return;
+    }
+    lock.unlock();
+
+    av_packet_free(&packet);
+}
+
+} // namespace AV::Utils
@@ -0,0 +1,153 @@
+/**
+ * @file packetqueue.hpp
+ * @brief Demux read-ahead queue bounded by bytes and duration, and a pool of packets to fill it
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#pragma once
+
+// 3rd Party Dependencies
+extern "C" {
+#include <libavcodec/packet.h>
+}
+
+// Standard C++ Dependencies
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// Defines
+#define AVUTILS_PACKET_QUEUE_CAPACITY 1024
+#define AVUTILS_PACKET_QUEUE_MAX_BYTES (32 * 1024 * 1024)
+#define AVUTILS_PACKET_QUEUE_MAX_DURATION_US 2000000
+
+namespace AV::Utils {
+
+/**
+ * @brief How far the demuxer may read ahead of a decoder, whichever bound is hit first
+ */
+typedef struct PacketQueueConfig {
+    size_t max_packets = AVUTILS_PACKET_QUEUE_CAPACITY;
+    size_t max_bytes = AVUTILS_PACKET_QUEUE_MAX_BYTES;
+    int64_t max_duration_us = AVUTILS_PACKET_QUEUE_MAX_DURATION_US;
+} PacketQueueConfig;
+
+/**
+ * @brief A blocking packet queue joining the demuxer to a decoder.
+ *
+ * It behaves like a BoundedQueue of packets, but is full once it holds max_packets,
+ * max_bytes of payload or max_duration_us of media. A duration bound keeps every stream
+ * the same distance ahead whatever its bitrate. An empty queue always takes a packet,
+ * so a packet larger than the byte bound still gets through.
+ *
+ * Durations come from AVPacket::duration in AVPacket::time_base, packets without
+ * either only count against the packet and byte bounds. Null packets are allowed
+ * and count against nothing but the packet bound.
+ *
+ * The queue does not own what it stores, anything left inside after an abort
+ * has to be pulled out with TryPop() and released by the caller.
+ */
+class PacketQueue {
+public:
+    PacketQueue(const PacketQueueConfig &config = {}) : _config(config) {}
+
+    PacketQueue(const PacketQueue &) = delete;
+    PacketQueue &operator=(const PacketQueue &) = delete;
+
+    /**
+     * @brief Push a packet, blocking while the queue is full
+     *
+     * @param packet The packet to push
+     * @return bool False if the queue was closed or aborted, the caller keeps ownership of the packet
+     */
+    bool Push(AVPacket *packet);
+
+    /**
+     * @brief Pop a packet, blocking while the queue is empty
+     *
+     * @param packet Receives the popped packet
+     * @return bool False once the queue is closed and drained, or aborted
+     */
+    bool Pop(AVPacket *&packet);
+
+    /**
+     * @brief Pop a packet without blocking. This also works after an abort
+     * so leftovers can be released.
+     *
+     * @param packet Receives the popped packet
+     * @return bool False if the queue is empty
+     */
+    bool TryPop(AVPacket *&packet);
+
+    /**
+     * @brief Stop accepting new packets, consumers can still drain the queue
+     */
+    void Close();
+
+    /**
+     * @brief Wake up all waiters and fail every blocking call from now on
+     */
+    void Abort();
+
+    size_t Size();
+    size_t GetBytes();
+    int64_t GetDurationUs();
+
+private:
+    static int64_t _Duration(const AVPacket *packet);
+    bool _Full() const;
+    void _Remove(AVPacket *&packet);
+
+    PacketQueueConfig _config;
+
+    std::deque<AVPacket *> _queue;
+    size_t _bytes = 0;
+    int64_t _duration_us = 0;
+
+    std::mutex _mutex;
+    std::condition_variable _not_empty;
+    std::condition_variable _not_full;
+    bool _closed = false;
+    bool _aborted = false;
+};
+
+/**
+ * @brief Recycles AVPacket structs between the demuxer and the decoders.
+ *
+ * Ref() hands out a packet referencing the payload of another, so nothing is copied.
+ * Release() drops the payload right away and keeps the empty packet for the next Ref().
+ */
+class PacketPool {
+public:
+    PacketPool() = default;
+    ~PacketPool();
+
+    PacketPool(const PacketPool &) = delete;
+    PacketPool &operator=(const PacketPool &) = delete;
+
+    /**
+     * @brief Get a packet referencing the payload and properties of another
+     *
+     * @param src The packet to reference
+     * @return AVPacket* The new reference, nullptr if allocating failed
+     */
+    AVPacket *Ref(const AVPacket *src);
+
+    /**
+     * @brief Give a packet back to the pool, null packets are ignored
+     *
+     * @param packet The packet, set to nullptr
+     */
+    void Release(AVPacket *&packet);
+
+private:
+    std::mutex _mutex;
+    std::vector<AVPacket *> _free;
+};
+
+} // namespace AV::Utils
@@ -0,0 +1,1107 @@
+/**
+ * @file pipeline.hpp
+ * @brief Staged playout pipeline shared by every App
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#pragma once
+
+// Local includes
+#include "averror.hpp"
+#include "demuxer.hpp"
+#include "decoder.hpp"
+#include "audioresampler.hpp"
+#include "audioaggregator.hpp"
+#include "frametimer.hpp"
+#include "boundedqueue.hpp"
+#include "packetqueue.hpp"
+#include "frame.hpp"
+#include "playoutcache.hpp"
+#include "threadpool.hpp"
+#include "macro.hpp"
+
+// 3rd Party Dependencies
+extern "C" {
+#include <libavcodec/codec_par.h>
+}
+
+// Standard C++ Dependencies
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace AV::Utils {
+
+/**
+ * @brief One NDI source fed by a pipeline
+ */
+typedef struct NDIOutputConfig {
+    std::string name;
+    int width = 0, height = 0; // Downscale to this size, 0 keeps the source resolution
+} NDIOutputConfig;
+
+/**
+ * @brief Where a pipeline reads from and where it sends to
+ */
+typedef struct PipelineConfig {
+    std::vector<NDIOutputConfig> ndi_outputs; // Every output shares the one decode
+    std::vector<std::string> video_file_paths; // Played back to back without a gap
+    size_t worker_threads = 0; // Threads splitting up work within a frame, 0 uses every core
+    DemuxerConfig demuxer_config; // How media files are read
+    DecoderConfig decoder_config; // Threading of the video decoder
+    PacketQueueConfig packet_queue_config; // How far the demuxer reads ahead of each decoder
+    bool async_video_send = true; // Overlap NDI compression of a frame with preparing the next
+    bool loop = false; // Start over at the end, a single file is seeked in place
+    std::string cache_dir; // Play from and record into pre-decoded playout caches here, empty disables them
+    bool build_cache_only = false; // Only record the caches, nothing is sent and the playlist runs once
+    std::shared_ptr<ThreadPool> worker_pool; // Shared with other pipelines in the process, null creates one of worker_threads
+    int priority = 0; // Work of higher priority pipelines goes first on a shared worker pool
+    bool pack_uyvy = false; // Hardware decodes are packed into UYVY on the CPU instead of sent to NDI as NV12
+} PipelineConfig;
+
+/**
+ * @brief Demux, decode, convert and send a playlist of media files.
+ *
+ * Every stage runs on its own thread and the stages are joined by bounded queues:
+ *
+ *   demux -> video decode -> convert -------------+
+ *         -> audio decode + resample + aggregate -+-> FrameTimer -> sink
+ *
+ * The calling thread of Run() orders frames through the FrameTimer and feeds the sink.
+ * The demux thread reads ahead into a packet queue per stream, bounded by packets, bytes
+ * and duration, so slow storage only stalls the decoders once the read-ahead runs dry.
+ *
+ * Each playlist item gets its own demuxer, decoders, conversion and stage threads. While
+ * one item plays the next one is opened and its stages started on the side, so they have
+ * filled their queues by the time it is needed. Its timestamps are moved to start where
+ * the previous item ended, the FrameTimer and sink live for the whole playlist. The sink
+ * runs at the frame rate of the first item.
+ *
+ * A looping playlist wraps around to its first item the same way. A single looping file
+ * is not reopened, the demuxer seeks back to the start and marks the seam with a null
+ * packet. The decoders drain and flush when they see it, every other object stays as is,
+ * and the packets of each pass are moved past the end of the one before.
+ *
+ * With a cache directory configured, the first playout of a file also records its UYVY
+ * frames and audio chunks into a PlayoutCache. Later playouts of the file map the cache
+ * and skip demux, decode, conversion and resampling, one thread hands the mapped frames
+ * straight to the output queue.
+ *
+ * Several pipelines may run in one process on a shared worker pool. Their stage threads
+ * start the pool's loops at the pipeline priority, so live channels get the workers
+ * ahead of previews.
+ *
+ * The video specific parts are compile time policies, so the per frame calls are
+ * resolved statically:
+ *
+ * DecoderPolicy: Initialize(codecpar, decoder_config), Fill(packet), Decode(), Flush()
+ * ConvertPolicy: Initialize(codecpar, time_base, thread_pool), Convert(frame, emit), kOwnStage
+ *                Convert() owns the frame it is given and moves every output frame into emit.
+ *                When kOwnStage is false conversion runs inline on the video decode thread.
+ * SinkPolicy:    Initialize(config, frame_rate, thread_pool), Send(frame)
+ *
+ * Frames travel as FramePtr and are moved from stage to stage, a decoded frame is never
+ * referenced a second time on its way to the sink.
+ */
+template <typename DecoderPolicy, typename ConvertPolicy, typename SinkPolicy>
+class Pipeline {
+public:
+    using PipelineResult = std::pair<std::unique_ptr<Pipeline>, AvException>;
+
+    /**
+     * @brief Create a new Pipeline object
+     *
+     * @param config Where to read from and where to send to
+     * @return PipelineResult The Pipeline object
+     */
+    static PipelineResult Create(const PipelineConfig &config) {
+        FUNCTION_CALL_DEBUG();
+
+        try {
+            return {std::unique_ptr<Pipeline>(new Pipeline(config)), AvError::NOERROR};
+        } catch (const AvException &e) {
+            DEBUG("Error while creating pipeline: %s", e.what());
+            return {nullptr, e};
+        }
+    }
+
+    /**
+     * @brief Play the playlist until it is exhausted or a stage fails
+     *
+     * @return AvException The first error raised by any stage
+     */
+    AvException Run() {
+        FUNCTION_CALL_DEBUG();
+
+        // The sink scales on the worker pool from this thread
+        ThreadPool::SetPriority(_config.priority);
+
+        std::unique_ptr<Item> item = std::move(_first_item);
+        _StartItem(*item);
+
+        for (size_t index = 0; item != nullptr; index = (index + 1) % _config.video_file_paths.size()) {
+            // Open and prime the next item while this one plays
+            std::unique_ptr<Item> next_item;
+            AvError next_err = AvError::NOERROR;
+            std::thread preload_thread;
+            const size_t next_index = (index + 1) % _config.video_file_paths.size();
+            const bool has_next = _config.video_file_paths.size() > 1 && (_config.loop || index + 1 < _config.video_file_paths.size());
+            if (has_next) {
+                preload_thread = std::thread([this, next_index, &next_item, &next_err] {
+                    next_err = _OpenItem(_config.video_file_paths[next_index], next_item);
+                    if (next_err == AvError::NOERROR) {
+                        _StartItem(*next_item);
+                    }
+                });
+            }
+
+            int64_t end_us = _PlayItem(*item);
+
+            if (preload_thread.joinable()) {
+                preload_thread.join();
+            }
+
+            _JoinItem(*item);
+            item.reset();
+
+            if (next_err != AvError::NOERROR) {
+                ERROR("Failed to open %s: %s", _config.video_file_paths[next_index].c_str(), AvException(next_err).what());
+                _Fail(next_err);
+            }
+
+            if (_Failed()) {
+                if (next_item != nullptr) {
+                    _JoinItem(*next_item);
+                }
+
+                break;
+            }
+
+            // The next item picks up exactly where this one stopped
+            if (next_item != nullptr) {
+                next_item->pts_offset_us = end_us - next_item->start_us;
+                DEBUG("Switching to %s at %ld us", next_item->path.c_str(), end_us);
+            }
+
+            item = std::move(next_item);
+        }
+
+        // Drain whatever is left in the frame timer
+        while (!_Failed() && !_frame_timer.IsEmpty()) {
+            DEBUG("Draining frames!");
+            _SendTimedFrame();
+        }
+
+        std::lock_guard<std::mutex> lock(_error_mutex);
+        return _error;
+    }
+
+private:
+    /**
+     * @brief Everything that belongs to one playlist item
+     */
+    struct Item {
+        Item(const PacketQueueConfig &packet_queue_config) : video_packet_queue(packet_queue_config), audio_packet_queue(packet_queue_config) {}
+
+        std::string path;
+
+        std::unique_ptr<Demuxer> demuxer;
+        DecoderPolicy video_decoder;
+        ConvertPolicy convert;
+        std::unique_ptr<Decoder> audio_decoder;
+        std::unique_ptr<AudioResampler> audio_resampler;
+        AudioResamplerConfig audio_resampler_config{};
+        std::unique_ptr<AudioAggregator> audio_aggregator;
+
+        // Replaces every stage above when the item plays from its cache
+        std::shared_ptr<PlayoutCache> cache;
+
+        // Records the first pass of the item, each stream marks its own pass done
+        std::unique_ptr<PlayoutCacheWriter> cache_writer;
+        bool video_cached = false;
+        bool audio_cached = false;
+        std::atomic<bool> cache_failed = false;
+        std::atomic<int> cache_pending = 2;
+
+        int video_stream_index = -1;
+        int audio_stream_index = -1;
+
+        // Decoders and filters do not set AVFrame::time_base, the FrameTimer needs it
+        AVRational video_time_base{};
+        AVRational audio_time_base{};
+        AVRational frame_rate{};
+
+        // First timestamp in the file and how far the item is moved on the output timeline, microseconds
+        int64_t start_us = 0;
+        int64_t pts_offset_us = 0;
+
+        // Packets travelling from the demuxer to the decoders, outlives the queues holding them
+        PacketPool packet_pool;
+
+        // Queues joining the pipeline stages, the packet queues are the demux read-ahead
+        PacketQueue video_packet_queue;
+        PacketQueue audio_packet_queue;
+        BoundedQueue<FramePtr> decoded_video_queue{AVUTILS_FRAME_QUEUE_CAPACITY};
+        BoundedQueue<FramePtr> output_queue{AVUTILS_FRAMETIMER_DEFAULT_CAPACITY};
+
+        // Video (decode or convert) and audio decode both feed the output queue
+        std::atomic<int> output_producers = 2;
+
+        std::vector<std::thread> threads;
+    };
+
+    Pipeline(const PipelineConfig &config) : _config(config) {
+        FUNCTION_CALL_DEBUG();
+
+        AvError err = _Initialize();
+        if (err != AvError::NOERROR) {
+            throw AvException(err);
+        }
+    }
+
+    AvError _Initialize() {
+        FUNCTION_CALL_DEBUG();
+
+        if (_config.video_file_paths.empty()) {
+            return AvError::OPENINPUT;
+        }
+
+        if (_config.build_cache_only) {
+            if (_config.cache_dir.empty()) {
+                return AvError::CACHEOPEN;
+            }
+
+            _config.loop = false;
+        }
+
+        // Video conversion and the sink split frames across the worker pool
+        _worker_pool = _config.worker_pool;
+        if (_worker_pool == nullptr) {
+            _worker_pool = std::make_shared<ThreadPool>(_config.worker_threads);
+        }
+
+        // The first item is opened up front, the sink takes its frame rate
+        AvError err = _OpenItem(_config.video_file_paths.front(), _first_item);
+        if (err != AvError::NOERROR) {
+            return err;
+        }
+
+        if (_config.build_cache_only) {
+            return AvError::NOERROR;
+        }
+
+        // Create the sink
+        err = _sink.Initialize(_config, _first_item->frame_rate, _worker_pool);
+        if (err != AvError::NOERROR) {
+            DEBUG("Sink error: %s", AvException(err).what());
+            return err;
+        }
+
+        return AvError::NOERROR;
+    }
+
+    /**
+     * @brief Open a file and set up every stage for it
+     *
+     * @param path The media file
+     * @param out Receives the item
+     * @return AvError The error code
+     */
+    AvError _OpenItem(const std::string &path, std::unique_ptr<Item> &out) {
+        FUNCTION_CALL_DEBUG();
+
+        auto item = std::make_unique<Item>(_config.packet_queue_config);
+        item->path = path;
+
+        std::string cache_path;
+        if (!_config.cache_dir.empty()) {
+            cache_path = PlayoutCachePath(_config.cache_dir, path);
+        }
+
+        // A cached file needs none of the stages below
+        if (!cache_path.empty()) {
+            auto [cache, cache_err] = PlayoutCache::Open(cache_path);
+            if (cache_err.code() == 0) {
+                DEBUG("Playing %s from %s", path.c_str(), cache_path.c_str());
+
+                item->frame_rate = cache->GetFrameRate();
+                item->video_time_base = av_inv_q(item->frame_rate);
+                item->audio_time_base = {1, cache->GetHeader().sample_rate};
+
+                // Audio ahead of the first video frame starts the item, as it would uncached
+                item->start_us = std::min<int64_t>(0, av_rescale_q(cache->GetAudioStart(), item->audio_time_base, {1, 1000000}));
+                item->cache = std::move(cache);
+
+                out = std::move(item);
+                return AvError::NOERROR;
+            }
+
+            if ((AvError)cache_err.code() != AvError::CACHEOPEN) {
+                DEBUG("Rebuilding playout cache %s: %s", cache_path.c_str(), cache_err.what());
+            }
+        }
+
+        // Create the demuxer
+        auto [demuxer, demuxer_err] = Demuxer::Create(path, _config.demuxer_config);
+        if (demuxer_err.code()) {
+            DEBUG("Demuxer error: %s", demuxer_err.what());
+            return (AvError)demuxer_err.code();
+        }
+
+        item->demuxer = std::move(demuxer);
+
+        // Get codecs and stream ids
+        AVCodecParameters *video_cparam = nullptr, *audio_cparam = nullptr;
+        int vcount = 0, acount = 0;
+        int64_t start_us = INT64_MAX;
+        int64_t video_start_us = AV_NOPTS_VALUE;
+        for (auto stream : item->demuxer->GetStreamPointers()) {
+            if (stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
+                video_cparam = stream->codecpar;
+                item->video_stream_index = stream->index;
+                item->video_time_base = stream->time_base;
+                item->frame_rate = stream->codecpar->framerate;
+                if (stream->start_time != AV_NOPTS_VALUE) {
+                    video_start_us = av_rescale_q(stream->start_time, stream->time_base, {1, 1000000});
+                }
+                vcount++;
+            } else if (stream->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
+                audio_cparam = stream->codecpar;
+                item->audio_stream_index = stream->index;
+                item->audio_time_base = stream->time_base;
+                acount++;
+            } else {
+                continue;
+            }
+
+            if (stream->start_time != AV_NOPTS_VALUE) {
+                start_us = std::min(start_us, av_rescale_q(stream->start_time, stream->time_base, {1, 1000000}));
+            }
+        }
+
+        if (acount != 1 && vcount != 1) {
+            DEBUG("Invalid amount of streams");
+            return AvError::STREAMCOUNT;
+        }
+
+        item->start_us = start_us == INT64_MAX ? 0 : start_us;
+
+        // Create the video decoder
+        AvError err = item->video_decoder.Initialize(video_cparam, _config.decoder_config);
+        if (err != AvError::NOERROR) {
+            DEBUG("Video decoder error: %s", AvException(err).what());
+            return err;
+        }
+
+        // Create the video conversion, it splits frames across the worker pool
+        err = item->convert.Initialize(video_cparam, item->video_time_base, _worker_pool);
+        if (err != AvError::NOERROR) {
+            DEBUG("Convert error: %s", AvException(err).what());
+            return err;
+        }
+
+        // Create the audio decoder, audio is too cheap to be worth threading
+        DecoderConfig audio_decoder_config{};
+        audio_decoder_config.thread_type = DecoderThreadType::NONE;
+
+        auto [audio_decoder, audio_decoder_err] = Decoder::Create(audio_cparam, audio_decoder_config);
+        if (audio_decoder_err.code()) {
+            DEBUG("Audio decoder error: %s", audio_decoder_err.what());
+            return (AvError)audio_decoder_err.code();
+        }
+
+        item->audio_decoder = std::move(audio_decoder);
+
+        // Create the audio resampler, NDI takes float planar stereo natively
+        item->audio_resampler_config = {};
+        item->audio_resampler_config.srcsamplerate = audio_cparam->sample_rate;
+        item->audio_resampler_config.dstsamplerate = audio_cparam->sample_rate;
+        item->audio_resampler_config.srcchannellayout = audio_cparam->ch_layout;
+        item->audio_resampler_config.dstchannellayout = AV_CHANNEL_LAYOUT_STEREO;
+        item->audio_resampler_config.srcsampleformat = (AVSampleFormat)audio_cparam->format;
+        item->audio_resampler_config.dstsampleformat = AV_SAMPLE_FMT_FLTP;
+
+        auto [audio_resampler, audio_resampler_err] = AudioResampler::Create(item->audio_resampler_config);
+        if (audio_resampler_err.code()) {
+            DEBUG("Audio resampler error: %s", audio_resampler_err.what());
+            return (AvError)audio_resampler_err.code();
+        }
+
+        item->audio_resampler = std::move(audio_resampler);
+
+        // Create the audio aggregator, it sends audio one video frame period at a time
+        AudioAggregatorConfig audio_aggregator_config{};
+        audio_aggregator_config.frame_rate = item->frame_rate;
+        audio_aggregator_config.start_us = video_start_us;
+        audio_aggregator_config.sample_rate = item->audio_resampler_config.dstsamplerate;
+        audio_aggregator_config.sample_fmt = item->audio_resampler_config.dstsampleformat;
+        audio_aggregator_config.ch_layout = item->audio_resampler_config.dstchannellayout;
+
+        auto [audio_aggregator, audio_aggregator_err] = AudioAggregator::Create(audio_aggregator_config);
+        if (audio_aggregator_err.code()) {
+            DEBUG("Audio aggregator error: %s", audio_aggregator_err.what());
+            return (AvError)audio_aggregator_err.code();
+        }
+
+        item->audio_aggregator = std::move(audio_aggregator);
+
+        // Record this playout, a cache needs a constant frame rate to index by
+        if (!cache_path.empty() && item->frame_rate.num > 0 && item->frame_rate.den > 0) {
+            PlayoutCacheFormat cache_format{};
+            cache_format.width = video_cparam->width;
+            cache_format.height = video_cparam->height;
+            cache_format.frame_rate = item->frame_rate;
+            cache_format.sample_rate = item->audio_resampler_config.dstsamplerate;
+            cache_format.channels = item->audio_resampler_config.dstchannellayout.nb_channels;
+
+            auto [cache_writer, cache_writer_err] = PlayoutCacheWriter::Create(cache_path, cache_format);
+            if (cache_writer_err.code()) {
+                DEBUG("Not caching %s: %s", path.c_str(), cache_writer_err.what());
+            }
+
+            item->cache_writer = std::move(cache_writer);
+        }
+
+        out = std::move(item);
+        return AvError::NOERROR;
+    }
+
+    /**
+     * @brief Start the stage threads of an item, they run until its output queue is full
+     */
+    void _StartItem(Item &item) {
+        FUNCTION_CALL_DEBUG();
+
+        std::unique_lock<std::mutex> lock(_error_mutex);
+        _live_items.push_back(&item);
+        if (_error.code()) {
+            _AbortItem(item);
+        }
+        lock.unlock();
+
+        if (item.cache != nullptr) {
+            item.threads.emplace_back(&Pipeline::_Thread_CachePlayout, this, std::ref(item));
+            return;
+        }
+
+        // Every stage gets its own thread
+        item.threads.emplace_back(&Pipeline::_Thread_Demux, this, std::ref(item));
+        item.threads.emplace_back(&Pipeline::_Thread_VideoDecode, this, std::ref(item));
+        item.threads.emplace_back(&Pipeline::_Thread_AudioDecode, this, std::ref(item));
+        if constexpr (ConvertPolicy::kOwnStage) {
+            item.threads.emplace_back(&Pipeline::_Thread_Convert, this, std::ref(item));
+        }
+    }
+
+    /**
+     * @brief Wait for the stage threads of an item and release what is still queued
+     */
+    void _JoinItem(Item &item) {
+        FUNCTION_CALL_DEBUG();
+
+        for (auto &thread : item.threads) {
+            thread.join();
+        }
+
+        item.threads.clear();
+
+        // Release anything still queued after a failure, queued frames free themselves
+        AVPacket *packet = nullptr;
+        while (item.video_packet_queue.TryPop(packet)) item.packet_pool.Release(packet);
+        while (item.audio_packet_queue.TryPop(packet)) item.packet_pool.Release(packet);
+
+        std::lock_guard<std::mutex> lock(_error_mutex);
+        _live_items.erase(std::find(_live_items.begin(), _live_items.end(), &item));
+    }
+
+    /**
+     * @brief Order the frames of an item through the FrameTimer and feed the sink
+     *
+     * @param item The item, moved by its pts offset
+     * @return int64_t Where the item ends on the output timeline, microseconds
+     */
+    int64_t _PlayItem(Item &item) {
+        FUNCTION_CALL_DEBUG();
+
+        int64_t end_us = item.start_us + item.pts_offset_us;
+
+        FramePtr frame;
+        while (item.output_queue.Pop(frame)) {
+            if (frame->pts != AV_NOPTS_VALUE) {
+                frame->pts += av_rescale_q(item.pts_offset_us, {1, 1000000}, frame->time_base);
+                end_us = std::max(end_us, _FrameEnd(item, frame.get()));
+            }
+
+            // Only building caches, the frame has been recorded already
+            if (_config.build_cache_only) {
+                continue;
+            }
+
+            auto err = _frame_timer.AddFrame(std::move(frame));
+            if (err.code()) {
+                ERROR("Failed to add frame to timer: %s", err.what());
+                _Fail(err);
+                break;
+            }
+
+            while (_frame_timer.IsHalf()) {
+                DEBUG("Sending out frames");
+                if (!_SendTimedFrame()) {
+                    break;
+                }
+            }
+        }
+
+        return end_us;
+    }
+
+    /**
+     * @brief When a frame stops being shown, microseconds
+     */
+    static int64_t _FrameEnd(const Item &item, const AVFrame *frame) {
+        int64_t end_us = av_rescale_q(frame->pts, frame->time_base, {1, 1000000});
+
+        if (frame->nb_samples > 0 && frame->sample_rate > 0) {
+            end_us += av_rescale_q(frame->nb_samples, {1, frame->sample_rate}, {1, 1000000});
+        } else if (item.frame_rate.num > 0 && item.frame_rate.den > 0) {
+            end_us += av_rescale_q(1, av_inv_q(item.frame_rate), {1, 1000000});
+        }
+
+        return end_us;
+    }
+
+    void _Thread_CachePlayout(Item &item) {
+        FUNCTION_CALL_DEBUG();
+
+        if (_config.build_cache_only) {
+            PRINT("Already cached %s", item.path.c_str());
+            item.output_queue.Close();
+            return;
+        }
+
+        const bool loop_in_place = _config.loop && _config.video_file_paths.size() == 1;
+        const int64_t frame_count = item.cache->GetFrameCount();
+        const AVRational audio_time_base = item.audio_time_base;
+
+        // Audio keeps the offset from the video it was recorded with, audio that started
+        // ahead of the video has chunks left over after the last frame
+        const int64_t audio_start = item.cache->GetAudioStart();
+        const int64_t record_count = std::max(frame_count, item.cache->GetAudioChunkCount());
+
+        int64_t audio_pts = audio_start;
+        for (int64_t pass = 0; !_Failed(); pass++) {
+            for (int64_t index = 0; index < record_count; index++) {
+                if (index < frame_count) {
+                    FramePtr video_frame = item.cache->GetVideoFrame(index);
+                    if (video_frame == nullptr) {
+                        _Fail(AvError::FRAMEALLOC);
+                        return;
+                    }
+
+                    video_frame->pts = pass * frame_count + index;
+                    video_frame->time_base = item.video_time_base;
+                    if (!item.output_queue.Push(std::move(video_frame))) {
+                        return;
+                    }
+                }
+
+                // Records without audio have nothing to send
+                FramePtr audio_frame = item.cache->GetAudioFrame(index);
+                if (audio_frame == nullptr) {
+                    continue;
+                }
+
+                audio_frame->pts = audio_pts;
+                audio_frame->time_base = audio_time_base;
+                audio_pts += audio_frame->nb_samples;
+                if (!item.output_queue.Push(std::move(audio_frame))) {
+                    return;
+                }
+            }
+
+            if (!loop_in_place) {
+                break;
+            }
+
+            // Every pass starts with its first video frame, whatever the audio added up to
+            audio_pts = av_rescale_q((pass + 1) * frame_count, item.video_time_base, audio_time_base) + audio_start;
+        }
+
+        item.output_queue.Close();
+    }
+
+    void _Thread_Demux(Item &item) {
+        FUNCTION_CALL_DEBUG();
+
+        const bool loop_in_place = _config.loop && _config.video_file_paths.size() == 1;
+        auto streams = item.demuxer->GetStreamPointers();
+
+        // Where the current pass ends in file time, and how far it is moved on, microseconds
+        int64_t pass_end_us = item.start_us;
+        int64_t loop_offset_us = 0;
+
+        while (!_Failed()) {
+            auto [packet, packet_err] = item.demuxer->ReadFrame();
+            if (packet_err.code()) {
+                if ((AvError)packet_err.code() == AvError::DEMUXEREOF) {
+                    if (loop_in_place && pass_end_us > item.start_us) {
+                        if (!_LoopSeam(item)) {
+                            return;
+                        }
+
+                        loop_offset_us += pass_end_us - item.start_us;
+                        pass_end_us = item.start_us;
+                        DEBUG("Looping, next pass at %ld us", loop_offset_us);
+                        continue;
+                    }
+
+                    DEBUG("Packets exhausted");
+                    break;
+                }
+
+                ERROR("Failed to read packet: %s", packet_err.what());
+                _Fail(packet_err);
+                return;
+            }
+
+            PacketQueue *queue = nullptr;
+            if (packet->stream_index == item.video_stream_index) {
+                queue = &item.video_packet_queue;
+            } else if (packet->stream_index == item.audio_stream_index) {
+                queue = &item.audio_packet_queue;
+            } else {
+                continue;
+            }
+
+            // The demuxer reuses its packet, so hand a reference down the pipeline
+            AVPacket *packet_copy = item.packet_pool.Ref(packet);
+            if (packet_copy == nullptr) {
+                _Fail(AvError::PACKETALLOC);
+                return;
+            }
+
+            // The packet queues bound their read-ahead by duration, make sure every packet has one
+            AVStream *stream = streams[packet->stream_index];
+            packet_copy->time_base = stream->time_base;
+            if (packet_copy->duration <= 0 && packet->stream_index == item.video_stream_index && item.frame_rate.num > 0) {
+                packet_copy->duration = av_rescale_q(1, av_inv_q(item.frame_rate), stream->time_base);
+            }
+
+            if (loop_in_place) {
+                if (packet->pts != AV_NOPTS_VALUE) {
+                    pass_end_us = std::max(pass_end_us, av_rescale_q(packet->pts + packet_copy->duration, stream->time_base, {1, 1000000}));
+                }
+
+                // Every pass carries on from the end of the one before
+                int64_t offset = av_rescale_q(loop_offset_us, {1, 1000000}, stream->time_base);
+                if (packet_copy->pts != AV_NOPTS_VALUE) {
+                    packet_copy->pts += offset;
+                }
+
+                if (packet_copy->dts != AV_NOPTS_VALUE) {
+                    packet_copy->dts += offset;
+                }
+            }
+
+            if (!queue->Push(packet_copy)) {
+                item.packet_pool.Release(packet_copy);
+                return;
+            }
+        }
+
+        item.video_packet_queue.Close();
+        item.audio_packet_queue.Close();
+    }
+
+    /**
+     * @brief Seek back to the start of an item and mark the seam for the decoders
+     *
+     * @param item The item to loop
+     * @return bool False if the pipeline is shutting down
+     */
+    bool _LoopSeam(Item &item) {
+        auto err = item.demuxer->Seek(item.start_us);
+        if (err.code()) {
+            ERROR("Failed to loop: %s", err.what());
+            _Fail(err);
+            return false;
+        }
+
+        return item.video_packet_queue.Push(nullptr) && item.audio_packet_queue.Push(nullptr);
+    }
+
+    void _Thread_VideoDecode(Item &item) {
+        FUNCTION_CALL_DEBUG();
+
+        // Inline conversion runs on the worker pool from this thread
+        ThreadPool::SetPriority(_config.priority);
+
+        AVPacket *packet = nullptr;
+        bool draining = false;
+
+        while (!draining) {
+            // A null packet puts the decoder in draining mode once the demuxer is done
+            if (!item.video_packet_queue.Pop(packet)) {
+                if (_Failed()) {
+                    return;
+                }
+
+                packet = nullptr;
+                draining = true;
+            }
+
+            // A null packet in the queue is a loop seam, drain the decoder and flush it afterwards
+            const bool seam = !draining && packet == nullptr;
+
+            auto err = item.video_decoder.Fill(packet);
+            item.packet_pool.Release(packet);
+            if (err.code()) {
+                ERROR("Failed to fill video decoder: %s", err.what());
+                _Fail(err);
+                return;
+            }
+
+            while (1) {
+                auto [decoded_frame, decoder_err] = item.video_decoder.Decode();
+                if (decoder_err.code()) {
+                    if ((AvError)decoder_err.code() == AvError::DECODEREXHAUSTED) {
+                        DEBUG("Decoder exhausted");
+                        break;
+                    }
+
+                    ERROR("Failure in decoder: %s", decoder_err.what());
+                    _Fail(decoder_err);
+                    return;
+                }
+
+                // The decoder reuses its frame, so move its buffers down the pipeline
+                FramePtr frame = TakeFrame(decoded_frame);
+                if (frame == nullptr) {
+                    _Fail(AvError::FRAMEALLOC);
+                    return;
+                }
+
+                if constexpr (ConvertPolicy::kOwnStage) {
+                    if (!item.decoded_video_queue.Push(std::move(frame))) {
+                        return;
+                    }
+                } else if (!_ConvertFrame(item, std::move(frame))) {
+                    return;
+                }
+            }
+
+            if (seam) {
+                item.video_decoder.Flush();
+
+                // Mark the seam for the convert stage, the cache only records the first pass
+                if constexpr (ConvertPolicy::kOwnStage) {
+                    if (!item.decoded_video_queue.Push(nullptr)) {
+                        return;
+                    }
+                } else {
+                    _CachePassDone(item, item.video_cached);
+                }
+            }
+        }
+
+        if constexpr (ConvertPolicy::kOwnStage) {
+            item.decoded_video_queue.Close();
+        } else {
+            _CachePassDone(item, item.video_cached);
+            _FinishOutputProducer(item);
+        }
+    }
+
+    void _Thread_Convert(Item &item) {
+        FUNCTION_CALL_DEBUG();
+
+        ThreadPool::SetPriority(_config.priority);
+
+        FramePtr frame;
+        while (item.decoded_video_queue.Pop(frame)) {
+            // A null frame is a loop seam
+            if (frame == nullptr) {
+                _CachePassDone(item, item.video_cached);
+                continue;
+            }
+
+            if (!_ConvertFrame(item, std::move(frame))) {
+                return;
+            }
+        }
+
+        _CachePassDone(item, item.video_cached);
+        _FinishOutputProducer(item);
+    }
+
+    /**
+     * @brief Convert a decoded video frame and queue the result for output
+     *
+     * @param item The item the frame belongs to
+     * @param frame The decoded frame
+     * @return bool False if the pipeline is shutting down
+     */
+    bool _ConvertFrame(Item &item, FramePtr &&frame) {
+        auto err = item.convert.Convert(std::move(frame), [this, &item](FramePtr &&converted) {
+            converted->time_base = item.video_time_base;
+            if (_Caching(item, item.video_cached)) {
+                _CacheResult(item, item.cache_writer->AddVideo(converted.get()));
+            }
+
+            return item.output_queue.Push(std::move(converted));
+        });
+
+        if (err.code()) {
+            ERROR("Failure in convert: %s", err.what());
+            _Fail(err);
+            return false;
+        }
+
+        return !_Failed();
+    }
+
+    void _Thread_AudioDecode(Item &item) {
+        FUNCTION_CALL_DEBUG();
+
+        AVPacket *packet = nullptr;
+        bool draining = false;
+
+        while (!draining) {
+            // A null packet puts the decoder in draining mode once the demuxer is done
+            if (!item.audio_packet_queue.Pop(packet)) {
+                if (_Failed()) {
+                    return;
+                }
+
+                packet = nullptr;
+                draining = true;
+            }
+
+            // A null packet in the queue is a loop seam, drain the decoder and flush it afterwards
+            const bool seam = !draining && packet == nullptr;
+
+            auto err = item.audio_decoder->FillDecoder(packet);
+            item.packet_pool.Release(packet);
+            if (err.code()) {
+                ERROR("Failed to fill audio decoder: %s", err.what());
+                _Fail(err);
+                return;
+            }
+
+            while (1) {
+                auto [decoded_frame, decoder_err] = item.audio_decoder->Decode();
+                if (decoder_err.code()) {
+                    if ((AvError)decoder_err.code() == AvError::DECODEREXHAUSTED) {
+                        DEBUG("Decoder exhausted");
+                        break;
+                    }
+
+                    ERROR("Failure in decoder: %s", decoder_err.what());
+                    _Fail(decoder_err);
+                    return;
+                }
+
+                // Audio that is already float planar stereo (most AAC) skips swresample entirely
+                AVFrame *output_frame = decoded_frame;
+                if (!_IsNativeAudio(item, decoded_frame)) {
+                    auto [resampled_frame, resampled_frame_err] = item.audio_resampler->Resample(decoded_frame);
+                    if (resampled_frame_err.code()) {
+                        ERROR("Failure in resampler: %s", resampled_frame_err.what());
+                        _Fail(resampled_frame_err);
+                        return;
+                    }
+
+                    output_frame = resampled_frame;
+                }
+
+                // Regroup into chunks of one video frame period
+                output_frame->time_base = item.audio_time_base;
+
+                err = item.audio_aggregator->AddFrame(output_frame);
+                if (err.code()) {
+                    ERROR("Failure in audio aggregator: %s", err.what());
+                    _Fail(err);
+                    return;
+                }
+
+                if (!_PushAudioChunks(item, false)) {
+                    return;
+                }
+            }
+
+            // The next pass anchors its own chunk timestamps
+            if (seam) {
+                item.audio_decoder->Flush();
+
+                if (!_PushAudioChunks(item, true)) {
+                    return;
+                }
+
+                _CachePassDone(item, item.audio_cached);
+                item.audio_aggregator->Reset();
+            }
+        }
+
+        // Send the samples short of a full chunk too
+        if (!_PushAudioChunks(item, true)) {
+            return;
+        }
+
+        _CachePassDone(item, item.audio_cached);
+        _FinishOutputProducer(item);
+    }
+
+    /**
+     * @brief Queue every complete chunk the aggregator holds for output
+     *
+     * @param item The item the audio belongs to
+     * @param flush Also queue a final short chunk
+     * @return bool False if the pipeline is shutting down
+     */
+    bool _PushAudioChunks(Item &item, bool flush) {
+        while (1) {
+            auto [chunk, chunk_err] = item.audio_aggregator->GetChunk(flush);
+            if (chunk_err.code()) {
+                if ((AvError)chunk_err.code() == AvError::AGGREGATOREXHAUSTED) {
+                    return true;
+                }
+
+                ERROR("Failure in audio aggregator: %s", chunk_err.what());
+                _Fail(chunk_err);
+                return false;
+            }
+
+            if (_Caching(item, item.audio_cached)) {
+                _CacheResult(item, item.cache_writer->AddAudio(chunk.get()));
+            }
+
+            // Chunks carry their own time base, counted in samples
+            if (!item.output_queue.Push(std::move(chunk))) {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * @brief Check if a stream of an item is still being recorded into its cache
+     */
+    static bool _Caching(const Item &item, bool cached) {
+        return item.cache_writer != nullptr && !cached && !item.cache_failed;
+    }
+
+    /**
+     * @brief Give up on the cache of an item if recording a frame failed, playout goes on
+     */
+    static void _CacheResult(Item &item, const AvException &err) {
+        if (err.code() && !item.cache_failed.exchange(true)) {
+            DEBUG("Not caching %s: %s", item.path.c_str(), err.what());
+        }
+    }
+
+    /**
+     * @brief Mark the first pass of a stream recorded, the last stream done finishes the cache.
+     * An abandoned cache is removed along with its writer.
+     *
+     * @param item The item being recorded
+     * @param cached The cached flag of the stream
+     */
+    void _CachePassDone(Item &item, bool &cached) {
+        if (item.cache_writer == nullptr || cached) {
+            return;
+        }
+
+        cached = true;
+        if (--item.cache_pending > 0 || item.cache_failed || _Failed()) {
+            return;
+        }
+
+        auto err = item.cache_writer->Finish();
+        if (err.code()) {
+            DEBUG("Failed to finish the cache of %s: %s", item.path.c_str(), err.what());
+            return;
+        }
+
+        PRINT("Cached %s", item.path.c_str());
+    }
+
+    /**
+     * @brief Check if decoded audio can go to the sink without resampling
+     */
+    static bool _IsNativeAudio(const Item &item, const AVFrame *frame) {
+        return frame->format == AV_SAMPLE_FMT_FLTP && frame->sample_rate == item.audio_resampler_config.dstsamplerate &&
+               frame->ch_layout.nb_channels == item.audio_resampler_config.dstchannellayout.nb_channels;
+    }
+
+    /**
+     * @brief Send the earliest frame in the timer to the sink
+     *
+     * @return bool False if sending failed
+     */
+    bool _SendTimedFrame() {
+        auto err = _sink.Send(_frame_timer.GetFrame());
+        if (err.code()) {
+            ERROR("Failed to send frame: %s", err.what());
+            _Fail(err);
+            return false;
+        }
+
+        return true;
+    }
+
+    void _FinishOutputProducer(Item &item) {
+        // The last producer out closes the output queue
+        if (--item.output_producers == 0) {
+            item.output_queue.Close();
+        }
+    }
+
+    static void _AbortItem(Item &item) {
+        item.video_packet_queue.Abort();
+        item.audio_packet_queue.Abort();
+        item.decoded_video_queue.Abort();
+        item.output_queue.Abort();
+    }
+
+    void _Fail(const AvException &err) {
+        std::lock_guard<std::mutex> lock(_error_mutex);
+        if (!_error.code()) {
+            _error = err;
+        }
+
+        // Unblock every stage of every item so they can unwind
+        for (Item *item : _live_items) {
+            _AbortItem(*item);
+        }
+    }
+
+    bool _Failed() {
+        std::lock_guard<std::mutex> lock(_error_mutex);
+        return _error.code() != 0;
+    }
+
+    PipelineConfig _config;
+
+    std::shared_ptr<ThreadPool> _worker_pool;
+
+    // Opened by _Initialize(), handed to Run()
+    std::unique_ptr<Item> _first_item;
+
+    SinkPolicy _sink;
+    FrameTimer _frame_timer;
+
+    // Items with running stages, guarded by the error mutex
+    std::vector<Item *> _live_items;
+
+    std::mutex _error_mutex;
+    AvException _error;
+};
+
+} // namespace AV::Utils
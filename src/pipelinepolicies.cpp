@@ -0,0 +1,265 @@
+/**
+ * @file pipelinepolicies.cpp
+ * @brief Decoder, convert and sink policies for the Pipeline template
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+// Local includes
+#include "pipelinepolicies.hpp"
+#include "macro.hpp"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace AV::Utils {
+
+AvError SoftwareDecodePolicy::Initialize(AVCodecParameters *codecpar, const DecoderConfig &config) {
+    FUNCTION_CALL_DEBUG();
+
+    auto [decoder, decoder_err] = Decoder::Create(codecpar, config);
+    if (decoder_err.code()) {
+        return (AvError)decoder_err.code();
+    }
+
+    _decoder = std::move(decoder);
+    return AvError::NOERROR;
+}
+
+AvError VAAPIDecodePolicy::Initialize(AVCodecParameters *codecpar, const DecoderConfig &) {
+    FUNCTION_CALL_DEBUG();
+
+    auto [decoder, decoder_err] = VAAPIDecoder::Create(codecpar);
+    if (decoder_err.code()) {
+        return (AvError)decoder_err.code();
+    }
+
+    _decoder = std::move(decoder);
+    return AvError::NOERROR;
+}
+
+AvError CudaDecodePolicy::Initialize(AVCodecParameters *codecpar, const DecoderConfig &) {
+    FUNCTION_CALL_DEBUG();
+
+    auto [decoder, decoder_err] = CudaDecoder::Create(codecpar);
+    if (decoder_err.code()) {
+        return (AvError)decoder_err.code();
+    }
+
+    _decoder = std::move(decoder);
+    return AvError::NOERROR;
+}
+
+AvError FilterConvertPolicy::Initialize(const AVCodecParameters *codecpar, const AVRational &time_base, const std::shared_ptr<ThreadPool> &) {
+    FUNCTION_CALL_DEBUG();
+
+    const std::string filter_description = "format=uyvy422";
+    auto [filter, filter_err] = SimpleFilter::CreateFilter(filter_description, codecpar, time_base);
+    if (filter_err.code()) {
+        return (AvError)filter_err.code();
+    }
+
+    _filter = std::move(filter);
+    return AvError::NOERROR;
+}
+
+AvError UYVYConvertPolicy::Initialize(const AVCodecParameters *, const AVRational &time_base, const std::shared_ptr<ThreadPool> &thread_pool) {
+    FUNCTION_CALL_DEBUG();
+
+    _time_base = time_base;
+    _thread_pool = thread_pool;
+    return AvError::NOERROR;
+}
+
+AvError UYVYConvertPolicy::_PrepareConverter(const AVFrame *frame) {
+    if (_converter != nullptr && frame->width == _converter_width && frame->height == _converter_height && frame->format == _converter_format) {
+        return AvError::NOERROR;
+    }
+
+    UYVYConverterConfig config{};
+    config.width = frame->width;
+    config.height = frame->height;
+    config.src_pix_fmt = (AVPixelFormat)frame->format;
+    config.thread_pool = _thread_pool;
+
+    auto [converter, converter_err] = UYVYConverter::Create(config);
+    if (converter_err.code()) {
+        return (AvError)converter_err.code();
+    }
+
+    _converter = std::move(converter);
+    _converter_width = frame->width;
+    _converter_height = frame->height;
+    _converter_format = frame->format;
+
+    return AvError::NOERROR;
+}
+
+AvError UYVYConvertPolicy::_PrepareFilter(const AVFrame *frame) {
+    if (_filter_ready && frame->width == _filter_width && frame->height == _filter_height && frame->format == _filter_format) {
+        return AvError::NOERROR;
+    }
+
+    DEBUG("No UYVY kernel for %s (range %d), falling back to a filter graph", av_get_pix_fmt_name((AVPixelFormat)frame->format), (int)frame->color_range);
+
+    AVCodecParameters *codecpar = avcodec_parameters_alloc();
+    if (codecpar == nullptr) {
+        return AvError::AVMALLOC;
+    }
+
+    codecpar->width = frame->width;
+    codecpar->height = frame->height;
+    codecpar->format = frame->format;
+    codecpar->sample_aspect_ratio = frame->sample_aspect_ratio;
+
+    AvError err = _filter.Initialize(codecpar, _time_base);
+    avcodec_parameters_free(&codecpar);
+    if (err != AvError::NOERROR) {
+        return err;
+    }
+
+    _filter_ready = true;
+    _filter_width = frame->width;
+    _filter_height = frame->height;
+    _filter_format = frame->format;
+
+    return AvError::NOERROR;
+}
+
+AvError NDISinkPolicy::Initialize(const PipelineConfig &config, const AVRational &frame_rate, const std::shared_ptr<ThreadPool> &thread_pool) {
+    FUNCTION_CALL_DEBUG();
+
+    if (config.ndi_outputs.empty()) {
+        return AvError::NDINOOUTPUTS;
+    }
+
+    _thread_pool = thread_pool;
+
+    for (const auto &output_config : config.ndi_outputs) {
+        auto [ndi_source, ndi_source_err] = AsyncNDISource::Create(output_config.name, frame_rate, config.async_video_send);
+        if (ndi_source_err.code()) {
+            return (AvError)ndi_source_err.code();
+        }
+
+        auto output = std::make_unique<Output>();
+        output->source = std::move(ndi_source);
+        output->width = output_config.width;
+        output->height = output_config.height;
+
+        DEBUG("NDI output %s: %dx%d", output_config.name.c_str(), output->width, output->height);
+        _outputs.push_back(std::move(output));
+    }
+
+    return AvError::NOERROR;
+}
+
+bool NDISinkPolicy::_IsScaled(const Output &output, const AVFrame *frame) {
+    return output.width > 0 && output.height > 0 && (output.width != frame->width || output.height != frame->height);
+}
+
+AvError NDISinkPolicy::_PrepareScaler(Output &output, const AVFrame *frame) {
+    if (output.scaler != nullptr && frame->width == output.scaler_width && frame->height == output.scaler_height && frame->format == output.scaler_format) {
+        return AvError::NOERROR;
+    }
+
+    // Scale within the format the source is sent in, NDI takes it either way
+    PixelEncoderConfig config{};
+    config.src_width = frame->width;
+    config.src_height = frame->height;
+    config.src_pix_fmt = (AVPixelFormat)frame->format;
+    config.dst_width = output.width;
+    config.dst_height = output.height;
+    config.dst_pix_fmt = (AVPixelFormat)frame->format;
+    config.thread_pool = _thread_pool;
+
+    auto [scaler, scaler_err] = PixelEncoder::Create(config);
+    if (scaler_err.code()) {
+        return (AvError)scaler_err.code();
+    }
+
+    output.scaler = std::move(scaler);
+    output.scaler_width = frame->width;
+    output.scaler_height = frame->height;
+    output.scaler_format = frame->format;
+
+    return AvError::NOERROR;
+}
+
+AvException NDISinkPolicy::_SendScaled(Output &output, const AVFrame *frame) {
+    AvError err = _PrepareScaler(output, frame);
+    if (err != AvError::NOERROR) {
+        return err;
+    }
+
+    FramePtr scaled_frame(av_frame_alloc());
+    if (scaled_frame == nullptr) {
+        return AvError::FRAMEALLOC;
+    }
+
+    scaled_frame->width = output.width;
+    scaled_frame->height = output.height;
+    scaled_frame->format = frame->format;
+
+    // Allocated at display height, so scaled NV12 goes to NDI without being packed
+    if (output.scaled_pool.GetBuffer(scaled_frame.get(), output.width, output.height) < 0) {
+        return AvError::FRAMEGETBUFFER;
+    }
+
+    auto scale_err = output.scaler->EncodeInto(frame, scaled_frame.get());
+    if (scale_err.code()) {
+        return scale_err;
+    }
+
+    return output.source->SendFrame(std::move(scaled_frame));
+}
+
+AvException NDISinkPolicy::Send(FramePtr &&frame) {
+    const bool video = frame->width != 0 && frame->height != 0;
+
+    // Downscales read the frame before any output takes it
+    if (video) {
+        for (auto &output : _outputs) {
+            if (!_IsScaled(*output, frame.get())) {
+                continue;
+            }
+
+            auto err = _SendScaled(*output, frame.get());
+            if (err.code()) {
+                return err;
+            }
+        }
+    }
+
+    // Everything else shares the frame, the last output takes it over
+    Output *last = nullptr;
+    for (auto &output : _outputs) {
+        if (video && _IsScaled(*output, frame.get())) {
+            continue;
+        }
+
+        if (last != nullptr) {
+            FramePtr shared_frame(CopyFrame(frame.get()));
+            if (shared_frame == nullptr) {
+                return AvError::FRAMEREF;
+            }
+
+            auto err = last->source->SendFrame(std::move(shared_frame));
+            if (err.code()) {
+                return err;
+            }
+        }
+
+        last = output.get();
+    }
+
+    if (last != nullptr) {
+        return last->source->SendFrame(std::move(frame));
+    }
+
+    return AvError::NOERROR;
+}
+
+} // namespace AV::Utils
@@ -0,0 +1,246 @@
+/**
+ * @file pipelinepolicies.hpp
+ * @brief Decoder, convert and sink policies for the Pipeline template
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#pragma once
+
+// Local includes
+#include "averror.hpp"
+#include "decoder.hpp"
+#include "vaapidecoder.hpp"
+#include "cudadecoder.hpp"
+#include "simplefilter.hpp"
+#include "uyvyconverter.hpp"
+#include "pixelencoder.hpp"
+#include "framepool.hpp"
+#include "asyncndisource.hpp"
+#include "threadpool.hpp"
+#include "frame.hpp"
+#include "pipeline.hpp"
+
+// 3rd Party Dependencies
+extern "C" {
+#include <libavcodec/codec_par.h>
+#include <libavutil/frame.h>
+}
+
+// Standard C++ Dependencies
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace AV::Utils {
+
+/**
+ * @brief Software video decoding
+ */
+class SoftwareDecodePolicy {
+public:
+    AvError Initialize(AVCodecParameters *codecpar, const DecoderConfig &config);
+
+    AvException Fill(AVPacket *packet) { return _decoder->FillDecoder(packet); }
+    DecoderOutput Decode() { return _decoder->Decode(); }
+    void Flush() { _decoder->Flush(); }
+
+private:
+    std::unique_ptr<Decoder> _decoder;
+};
+
+/**
+ * @brief VAAPI video decoding, frames come out in system memory.
+ * Decoding happens on the GPU, so the threading policy does not apply.
+ */
+class VAAPIDecodePolicy {
+public:
+    AvError Initialize(AVCodecParameters *codecpar, const DecoderConfig &config);
+
+    AvException Fill(AVPacket *packet) { return _decoder->FillVAAPIDecoder(packet); }
+    VAAPIDecoderOutput Decode() { return _decoder->Decode(); }
+    void Flush() { _decoder->Flush(); }
+
+private:
+    std::unique_ptr<VAAPIDecoder> _decoder;
+};
+
+/**
+ * @brief CUDA video decoding, frames come out in system memory.
+ * Decoding happens on the GPU, so the threading policy does not apply.
+ */
+class CudaDecodePolicy {
+public:
+    AvError Initialize(AVCodecParameters *codecpar, const DecoderConfig &config);
+
+    AvException Fill(AVPacket *packet) { return _decoder->FillCudaDecoder(packet); }
+    CudaDecoderOutput Decode() { return _decoder->Decode(); }
+    void Flush() { _decoder->Flush(); }
+
+private:
+    std::unique_ptr<CudaDecoder> _decoder;
+};
+
+/**
+ * @brief Convert decoded video to UYVY with a filter graph, on its own pipeline stage
+ */
+class FilterConvertPolicy {
+public:
+    static constexpr bool kOwnStage = true;
+
+    AvError Initialize(const AVCodecParameters *codecpar, const AVRational &time_base, const std::shared_ptr<ThreadPool> &thread_pool = nullptr);
+
+    /**
+     * @brief Filter a frame and hand every output frame to emit
+     *
+     * @param frame The frame to filter
+     * @param emit Takes an output frame, returns false if the pipeline is stopping
+     * @return AvException
+     */
+    template <typename Emit>
+    AvException Convert(FramePtr &&frame, Emit &&emit) {
+        auto err = _filter->FillFilter(std::move(frame));
+        if (err.code()) {
+            return err;
+        }
+
+        while (1) {
+            auto [filtered_frame, filtered_frame_err] = _filter->FilterFrame();
+            if (filtered_frame_err.code()) {
+                if ((AvError)filtered_frame_err.code() == AvError::FILTEREXHAUSTED) {
+                    break;
+                }
+
+                return filtered_frame_err;
+            }
+
+            // Move the references out of the filter's frame rather than cloning it
+            FramePtr output_frame = TakeFrame(filtered_frame);
+            if (output_frame == nullptr) {
+                return AvError::FRAMEALLOC;
+            }
+
+            if (!emit(std::move(output_frame))) {
+                break;
+            }
+        }
+
+        return AvError::NOERROR;
+    }
+
+private:
+    std::unique_ptr<SimpleFilter> _filter;
+};
+
+/**
+ * @brief Pack decoded video into UYVY with the vectorized converter, on its own pipeline stage.
+ * Formats the converter does not handle, and full range frames, go through a filter graph
+ * instead so swscale scales them to limited range. Both are set up from the frames themselves,
+ * since hardware downloads do not match the codec parameters.
+ */
+class UYVYConvertPolicy {
+public:
+    static constexpr bool kOwnStage = true;
+
+    AvError Initialize(const AVCodecParameters *codecpar, const AVRational &time_base, const std::shared_ptr<ThreadPool> &thread_pool);
+
+    template <typename Emit>
+    AvException Convert(FramePtr &&frame, Emit &&emit) {
+        if (!UYVYConverter::IsSupported((AVPixelFormat)frame->format) || frame->color_range == AVCOL_RANGE_JPEG) {
+            AvError err = _PrepareFilter(frame.get());
+            if (err != AvError::NOERROR) {
+                return err;
+            }
+
+            return _filter.Convert(std::move(frame), emit);
+        }
+
+        AvError err = _PrepareConverter(frame.get());
+        if (err != AvError::NOERROR) {
+            return err;
+        }
+
+        auto [uyvy_frame, uyvy_err] = _converter->Convert(frame.get());
+        if (uyvy_err.code()) {
+            return uyvy_err;
+        }
+
+        // Release the decoded frame before the UYVY one heads down the pipeline
+        frame.reset();
+
+        emit(FramePtr(uyvy_frame));
+        return AvError::NOERROR;
+    }
+
+private:
+    AvError _PrepareConverter(const AVFrame *frame);
+    AvError _PrepareFilter(const AVFrame *frame);
+
+    AVRational _time_base{};
+    std::shared_ptr<ThreadPool> _thread_pool;
+
+    std::unique_ptr<UYVYConverter> _converter;
+    int _converter_width = 0, _converter_height = 0, _converter_format = AV_PIX_FMT_NONE;
+
+    FilterConvertPolicy _filter;
+    bool _filter_ready = false;
+    int _filter_width = 0, _filter_height = 0, _filter_format = AV_PIX_FMT_NONE;
+};
+
+/**
+ * @brief Send decoded video as is. NDI takes the NV12 the hardware decoders produce,
+ * so the video decode thread emits straight to the output.
+ */
+class PassthroughConvertPolicy {
+public:
+    static constexpr bool kOwnStage = false;
+
+    AvError Initialize(const AVCodecParameters *, const AVRational &, const std::shared_ptr<ThreadPool> &) { return AvError::NOERROR; }
+
+    template <typename Emit>
+    AvException Convert(FramePtr &&frame, Emit &&emit) {
+        emit(std::move(frame));
+        return AvError::NOERROR;
+    }
+};
+
+/**
+ * @brief Send frames to one or more NDI sources.
+ *
+ * Every output is fed from the same decoded frames. Outputs at the source resolution
+ * share a reference to the frame, downscaled outputs get their own copy scaled across
+ * the worker pool into pooled buffers. Audio goes to every output as is.
+ */
+class NDISinkPolicy {
+public:
+    AvError Initialize(const PipelineConfig &config, const AVRational &frame_rate, const std::shared_ptr<ThreadPool> &thread_pool);
+
+    AvException Send(FramePtr &&frame);
+
+private:
+    struct Output {
+        std::shared_ptr<AsyncNDISource> source;
+        int width = 0, height = 0;
+
+        // Downscaled outputs only, set up from the first frame and again whenever its size or format changes
+        std::unique_ptr<PixelEncoder> scaler;
+        int scaler_width = 0, scaler_height = 0, scaler_format = AV_PIX_FMT_NONE;
+        FrameBufferPool scaled_pool;
+    };
+
+    static bool _IsScaled(const Output &output, const AVFrame *frame);
+    AvError _PrepareScaler(Output &output, const AVFrame *frame);
+    AvException _SendScaled(Output &output, const AVFrame *frame);
+
+    std::shared_ptr<ThreadPool> _thread_pool;
+    std::vector<std::unique_ptr<Output>> _outputs;
+};
+
+using SoftwarePipeline = Pipeline<SoftwareDecodePolicy, UYVYConvertPolicy, NDISinkPolicy>;
+using VAAPIPipeline = Pipeline<VAAPIDecodePolicy, PassthroughConvertPolicy, NDISinkPolicy>;
+using VAAPIUYVYPipeline = Pipeline<VAAPIDecodePolicy, UYVYConvertPolicy, NDISinkPolicy>;
+using CudaPipeline = Pipeline<CudaDecodePolicy, PassthroughConvertPolicy, NDISinkPolicy>;
+using CudaUYVYPipeline = Pipeline<CudaDecodePolicy, UYVYConvertPolicy, NDISinkPolicy>;
+
+} // namespace AV::Utils
@@ -5,6 +5,8 @@
  * @author Matthew Todd Geiger
  */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 
 #include "pixelencoder.hpp"
@@ -24,10 +26,6 @@ namespace AV::Utils {
  */
 PixelEncoderOutput PixelEncoder::Encode(AVFrame *frame) {
 FUNCTION_CALL_DEBUG();
-#ifdef _DEBUG
-    // Profile function
-    auto time_start = std::chrono::high_resolution_clock::now();
-#endif
 
     m_dst_frame->pts = frame->pts;
     m_dst_frame->pkt_dts = frame->pkt_dts;
@@ -36,11 +34,79 @@ FUNCTION_CALL_DEBUG();
     m_dst_frame->opaque = frame->opaque;
     m_dst_frame->best_effort_timestamp = frame->best_effort_timestamp;
 
-    // Scale the frame into the destination frame
-    int ret = sws_scale(m_sws_ctx, frame->data, frame->linesize, 0, m_config.src_height, m_dst_frame->data, m_dst_frame->linesize);
+    AvError err = m_Scale(frame, m_dst_frame);
+    if (err != AvError::NOERROR) {
+        return {nullptr, AvException(err)};
+    }
+
+    return {m_dst_frame, AvException(AvError::NOERROR)};
+}
+
+/**
+ * @brief Encode a frame into a frame owned by the caller
+ *
+ * @param frame The frame to encode
+ * @param dst_frame The destination, with buffers for dst_width x dst_height of dst_pix_fmt
+ * @return AvException The error code
+ */
+AvException PixelEncoder::EncodeInto(const AVFrame *frame, AVFrame *dst_frame) {
+    FUNCTION_CALL_DEBUG();
+
+    int ret = av_frame_copy_props(dst_frame, frame);
     if (ret < 0) {
         PRINT_FFMPEG_ERR(ret);
-        return {nullptr, AvException(AvError::SWSSCALE)};
+        return AvError::FRAMECOPY;
+    }
+
+    return m_Scale(frame, dst_frame);
+}
+
+/**
+ * @brief Scale a frame into a destination frame
+ *
+ * @param frame The source frame
+ * @param dst_frame The destination frame
+ * @return AvError The error code
+ */
+AvError PixelEncoder::m_Scale(const AVFrame *frame, AVFrame *dst_frame) {
+#ifdef _DEBUG
+    // Profile function
+    auto time_start = std::chrono::high_resolution_clock::now();
+#endif
+
+    if (m_bands.empty()) {
+        // Scale the frame into the destination frame
+        int ret = sws_scale(m_sws_ctx, frame->data, frame->linesize, 0, m_config.src_height, dst_frame->data, dst_frame->linesize);
+        if (ret < 0) {
+            PRINT_FFMPEG_ERR(ret);
+            return AvError::SWSSCALE;
+        }
+    } else {
+        // Every band context sees the whole source and produces its own rows of the destination
+        std::atomic<int> band_ret = 0;
+        m_config.thread_pool->ParallelFor(m_bands.size(), [this, frame, dst_frame, &band_ret](size_t band) {
+            SwsContext *sws_ctx = m_band_sws_ctxs[band];
+
+            int ret = sws_frame_start(sws_ctx, dst_frame, frame);
+            if (ret >= 0) {
+                ret = sws_send_slice(sws_ctx, 0, m_config.src_height);
+            }
+
+            if (ret >= 0) {
+                ret = sws_receive_slice(sws_ctx, m_bands[band].first, m_bands[band].second);
+            }
+
+            sws_frame_end(sws_ctx);
+
+            if (ret < 0) {
+                band_ret = ret;
+            }
+        });
+
+        if (band_ret < 0) {
+            PRINT_FFMPEG_ERR(band_ret.load());
+            return AvError::SWSSCALE;
+        }
     }
 
     // Print new frame metadata
@@ -51,7 +117,7 @@ FUNCTION_CALL_DEBUG();
             "  quality: %d\n"
             "  opaque: %p\n"
             "  best_effort_timestamp: %ld",
-            m_dst_frame->pts, m_dst_frame->pkt_dts, m_dst_frame->pict_type, m_dst_frame->quality, m_dst_frame->opaque, m_dst_frame->best_effort_timestamp);
+            dst_frame->pts, dst_frame->pkt_dts, dst_frame->pict_type, dst_frame->quality, dst_frame->opaque, dst_frame->best_effort_timestamp);
 
 #ifdef _DEBUG
     // Profile function
@@ -59,7 +125,7 @@ FUNCTION_CALL_DEBUG();
     DEBUG("Encode time (seconds): %f", std::chrono::duration<double>(time_end - time_start).count());
 #endif
 
-    return {m_dst_frame, AvException(AvError::NOERROR)};
+    return AvError::NOERROR;
 }
 
 /**
@@ -103,18 +169,17 @@ PixelEncoder::PixelEncoder(const pixelencoderconfig &config) : m_config(config)
 PixelEncoder::~PixelEncoder() {
     FUNCTION_CALL_DEBUG();
 
-    // Free the frame buffer
-    if (m_dst_frame_buffer) {
-        av_free(m_dst_frame_buffer);
-        DEBUG("av_free called");
-    }
-
     // Free the frame
     if (m_dst_frame) {
         av_frame_free(&m_dst_frame);
         DEBUG("av_frame_free called");
     }
 
+    // Free the band sws contexts
+    for (auto sws_ctx : m_band_sws_ctxs) {
+        sws_freeContext(sws_ctx);
+    }
+
     // Free the sws context
     if (m_sws_ctx) {
         sws_freeContext(m_sws_ctx);
@@ -145,24 +210,53 @@ AvError PixelEncoder::m_Initialize() {
         return AvError::FRAMEALLOC;
     }
 
-    // Allocate the buffer for the resize frame
-    int buffersize = av_image_get_buffer_size(m_config.dst_pix_fmt, m_config.dst_width, m_config.dst_height, 1);
-    m_dst_frame_buffer = (uint8_t *)av_malloc(buffersize);
-    if (!m_dst_frame_buffer) {
-        return AvError::AVMALLOC;
-    }
+    // Copy important metadata to the destination frame
+    m_dst_frame->width = m_config.dst_width;
+    m_dst_frame->height = m_config.dst_height;
+    m_dst_frame->format = m_config.dst_pix_fmt;
 
-    // Setup the data pointer to point to our buffer and set the linesize
-    int ret = av_image_fill_arrays(m_dst_frame->data, m_dst_frame->linesize, m_dst_frame_buffer, m_config.dst_pix_fmt, m_config.dst_width, m_config.dst_height, 1);
+    // Allocate the buffer for the resize frame
+    int ret = av_frame_get_buffer(m_dst_frame, 0);
     if (ret < 0) {
         PRINT_FFMPEG_ERR(ret);
-        return AvError::IMAGEFILLARRAYS;
+        return AvError::FRAMEGETBUFFER;
     }
 
-    // Copy important metadata to the destination frame
-    m_dst_frame->width = m_config.dst_width;
-    m_dst_frame->height = m_config.dst_height;
-    m_dst_frame->format = m_config.dst_pix_fmt;
+    if (m_config.thread_pool == nullptr || m_config.thread_pool->GetThreadCount() < 2) {
+        return AvError::NOERROR;
+    }
+
+    // Size the bands so one band of output fits in cache, rounded to what the scaler can produce
+    int alignment = (int)sws_receive_slice_alignment(m_sws_ctx);
+    int row_size = std::max(1, av_image_get_buffer_size(m_config.dst_pix_fmt, m_config.dst_width, m_config.dst_height, 1) / m_config.dst_height);
+    int band_rows = std::max(alignment, AVUTILS_BAND_BYTES / row_size / alignment * alignment);
+
+    // Every band owns a full sws context, so large frames get fewer, taller bands instead of one context per 256 KiB
+    int max_bands = (int)m_config.thread_pool->GetThreadCount() * AVUTILS_BANDS_PER_THREAD;
+    int min_band_rows = (m_config.dst_height + max_bands - 1) / max_bands;
+    band_rows = std::max(band_rows, (min_band_rows + alignment - 1) / alignment * alignment);
+
+    for (int row = 0; row < m_config.dst_height; row += band_rows) {
+        m_bands.push_back({row, std::min(band_rows, m_config.dst_height - row)});
+    }
+
+    if (m_bands.size() < 2) {
+        m_bands.clear();
+        return AvError::NOERROR;
+    }
+
+    for (size_t i = 0; i < m_bands.size(); i++) {
+        SwsContext *sws_ctx = sws_getContext(m_config.src_width, m_config.src_height, m_config.src_pix_fmt,
+                                             m_config.dst_width, m_config.dst_height, m_config.dst_pix_fmt,
+                                             SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!sws_ctx) {
+            return AvError::SWSCONTEXT;
+        }
+
+        m_band_sws_ctxs.push_back(sws_ctx);
+    }
+
+    DEBUG("PixelEncoder bands: %lu of %d rows", m_bands.size(), band_rows);
 
     return AvError::NOERROR;
 }
@@ -8,6 +8,7 @@
 #pragma once
 
 #include "averror.hpp"
+#include "threadpool.hpp"
 
 extern "C" {
 #include <libswscale/swscale.h>
@@ -15,6 +16,7 @@ extern "C" {
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace AV::Utils {
 
@@ -30,6 +32,7 @@ typedef struct PixelEncoderConfig {
     int src_width{}, src_height{};
     int dst_width{}, dst_height{};
     AVPixelFormat src_pix_fmt{}, dst_pix_fmt{};
+    std::shared_ptr<ThreadPool> thread_pool; // Optional, output rows are split into bands across it
 } pixelencoderconfig, *ppixelencoderconfig;
 
 /**
@@ -63,8 +66,19 @@ public:
      */
     PixelEncoderOutput Encode(AVFrame *frame);
 
+    /**
+     * @brief Encode a frame into a frame owned by the caller, so every output
+     * can live on after the next call
+     *
+     * @param frame The frame to encode
+     * @param dst_frame The destination, with buffers for dst_width x dst_height of dst_pix_fmt
+     * @return AvException The error code
+     */
+    AvException EncodeInto(const AVFrame *frame, AVFrame *dst_frame);
+
 private:
     AvError m_Initialize();
+    AvError m_Scale(const AVFrame *frame, AVFrame *dst_frame);
 
     // Store the configuration
     pixelencoderconfig m_config;
@@ -75,8 +89,9 @@ private:
     // Store the destination frame
     AVFrame *m_dst_frame = nullptr;
 
-    // Store the destination frame buffer;
-    uint8_t *m_dst_frame_buffer = nullptr;
+    // One sws context per band of output rows, so bands can be scaled concurrently
+    std::vector<SwsContext *> m_band_sws_ctxs;
+    std::vector<std::pair<int, int>> m_bands;
 };
 
 } // namespace AV::Utils
\ No newline at end of file
@@ -0,0 +1,451 @@
+/**
+ * @file playoutcache.cpp
+ * @brief Pre-decoded, memory mapped playout cache of NDI ready frames
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include "playoutcache.hpp"
+#include "macro.hpp"
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/common.h>
+#include <libavutil/mathematics.h>
+#include <libavutil/pixfmt.h>
+#include <libavutil/samplefmt.h>
+}
+
+// POSIX includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Standard C++ Dependencies
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+
+// Records start on a page boundary, so a frame never shares a page with its neighbours
+#define PLAYOUTCACHE_PAGE_SIZE 4096
+
+namespace AV::Utils {
+
+static uint64_t VideoSize(const PlayoutCacheHeader &header) {
+    return (uint64_t)header.line_stride * header.height;
+}
+
+static uint64_t AudioPlaneSize(const PlayoutCacheHeader &header) {
+    return (uint64_t)header.max_chunk_samples * sizeof(float);
+}
+
+std::string PlayoutCachePath(const std::string &cache_dir, const std::string &path) {
+    FUNCTION_CALL_DEBUG();
+
+    struct stat st {};
+    if (stat(path.c_str(), &st) != 0) {
+        return "";
+    }
+
+    std::string key = path + "|" + std::to_string(st.st_size) + "|" + std::to_string(st.st_mtim.tv_sec) + "." + std::to_string(st.st_mtim.tv_nsec);
+
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)std::hash<std::string>{}(key));
+
+    return (std::filesystem::path(cache_dir) / (std::filesystem::path(path).filename().string() + "." + hash + ".ndicache")).string();
+}
+
+PlayoutCacheWriterResult PlayoutCacheWriter::Create(const std::string &path, const PlayoutCacheFormat &format) {
+    FUNCTION_CALL_DEBUG();
+
+    try {
+        return {std::unique_ptr<PlayoutCacheWriter>(new PlayoutCacheWriter(path, format)), AvError::NOERROR};
+    } catch (const AvException &e) {
+        DEBUG("Error creating playout cache writer: %s", e.what());
+        return {nullptr, e};
+    }
+}
+
+PlayoutCacheWriter::PlayoutCacheWriter(const std::string &path, const PlayoutCacheFormat &format) : _path(path) {
+    FUNCTION_CALL_DEBUG();
+
+    memcpy(_header.magic, AVUTILS_PLAYOUTCACHE_MAGIC, sizeof(_header.magic));
+    _header.version = AVUTILS_PLAYOUTCACHE_VERSION;
+    _header.width = format.width;
+    _header.height = format.height;
+    _header.frame_rate_num = format.frame_rate.num;
+    _header.frame_rate_den = format.frame_rate.den;
+    _header.sample_rate = format.sample_rate;
+    _header.channels = format.channels;
+
+    AvError err = _Initialize();
+    if (err != AvError::NOERROR) {
+        throw AvException(err);
+    }
+}
+
+PlayoutCacheWriter::~PlayoutCacheWriter() {
+    FUNCTION_CALL_DEBUG();
+
+    if (_fd >= 0) {
+        close(_fd);
+    }
+
+    // An unfinished cache is useless, don't leave it lying around
+    if (!_finished && !_tmp_path.empty()) {
+        unlink(_tmp_path.c_str());
+    }
+}
+
+AvError PlayoutCacheWriter::_Initialize() {
+    FUNCTION_CALL_DEBUG();
+
+    if (_header.width <= 0 || _header.height <= 0 || _header.frame_rate_num <= 0 || _header.frame_rate_den <= 0 ||
+        _header.sample_rate <= 0 || _header.channels <= 0 || _header.channels > AV_NUM_DATA_POINTERS) {
+        return AvError::CACHEINVALID;
+    }
+
+    _header.line_stride = FFALIGN(_header.width * 2, 64);
+    _header.max_chunk_samples = (int)av_rescale_rnd(1, (int64_t)_header.sample_rate * _header.frame_rate_den, _header.frame_rate_num, AV_ROUND_UP);
+    _header.record_size = FFALIGN(VideoSize(_header) + AudioPlaneSize(_header) * _header.channels, (uint64_t)PLAYOUTCACHE_PAGE_SIZE);
+    _header.data_offset = PLAYOUTCACHE_PAGE_SIZE;
+
+    // Every writer gets its own file, two channels building the same cache don't collide
+    _tmp_path = _path + ".tmp." + std::to_string(getpid()) + "." + std::to_string((uintptr_t)this);
+
+    _fd = open(_tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (_fd < 0) {
+        ERROR("Failed to create %s: %s", _tmp_path.c_str(), strerror(errno));
+        _tmp_path.clear();
+        return AvError::CACHEOPEN;
+    }
+
+    DEBUG("Writing playout cache %s, %dx%d, %d/%d fps, records of %llu bytes", _path.c_str(), _header.width, _header.height,
+          _header.frame_rate_num, _header.frame_rate_den, (unsigned long long)_header.record_size);
+
+    return AvError::NOERROR;
+}
+
+AvError PlayoutCacheWriter::_Write(const void *data, size_t size, uint64_t offset) {
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    while (size > 0) {
+        ssize_t ret = pwrite(_fd, bytes, size, (off_t)offset);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (ret <= 0) {
+            DEBUG("Failed to write playout cache: %s", strerror(errno));
+            return AvError::CACHEWRITE;
+        }
+
+        bytes += ret;
+        size -= ret;
+        offset += ret;
+    }
+
+    return AvError::NOERROR;
+}
+
+AvException PlayoutCacheWriter::AddVideo(const AVFrame *frame) {
+    FUNCTION_CALL_DEBUG();
+
+    if (frame->format != AV_PIX_FMT_UYVY422 || frame->width != _header.width || frame->height != _header.height) {
+        return AvError::CACHEINVALID;
+    }
+
+    const uint64_t frame_index = _video_frames.load(std::memory_order_relaxed);
+    const uint64_t offset = _header.data_offset + _header.record_size * frame_index;
+    const size_t row_size = (size_t)_header.width * 2;
+
+    if (frame_index == 0 && frame->pts != AV_NOPTS_VALUE && frame->time_base.den > 0) {
+        _first_video_pts = av_rescale_q(frame->pts, frame->time_base, {1, _header.sample_rate});
+    }
+
+    if (frame->linesize[0] == _header.line_stride) {
+        AvError err = _Write(frame->data[0], VideoSize(_header), offset);
+        if (err != AvError::NOERROR) {
+            return err;
+        }
+    } else {
+        for (int y = 0; y < _header.height; y++) {
+            AvError err = _Write(frame->data[0] + (ptrdiff_t)frame->linesize[0] * y, row_size, offset + (uint64_t)_header.line_stride * y);
+            if (err != AvError::NOERROR) {
+                return err;
+            }
+        }
+    }
+
+    _video_frames.fetch_add(1, std::memory_order_relaxed);
+
+    return AvError::NOERROR;
+}
+
+AvException PlayoutCacheWriter::AddAudio(const AVFrame *frame) {
+    FUNCTION_CALL_DEBUG();
+
+    if (frame->format != AV_SAMPLE_FMT_FLTP || frame->ch_layout.nb_channels != _header.channels ||
+        frame->sample_rate != _header.sample_rate || frame->nb_samples > _header.max_chunk_samples) {
+        return AvError::CACHEINVALID;
+    }
+
+    const uint64_t chunk = _audio_chunks.load(std::memory_order_relaxed);
+    const uint64_t offset = _header.data_offset + _header.record_size * chunk + VideoSize(_header);
+
+    if (chunk == 0 && frame->pts != AV_NOPTS_VALUE && frame->time_base.den > 0) {
+        _first_audio_pts = av_rescale_q(frame->pts, frame->time_base, {1, _header.sample_rate});
+    }
+
+    for (int c = 0; c < _header.channels; c++) {
+        AvError err = _Write(frame->extended_data[c], (size_t)frame->nb_samples * sizeof(float), offset + AudioPlaneSize(_header) * c);
+        if (err != AvError::NOERROR) {
+            return err;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_index_mutex);
+        if (_audio_samples.size() <= chunk) {
+            _audio_samples.resize(chunk + 1);
+        }
+        _audio_samples[chunk] = (uint32_t)frame->nb_samples;
+    }
+
+    _audio_chunks.fetch_add(1, std::memory_order_relaxed);
+
+    return AvError::NOERROR;
+}
+
+AvException PlayoutCacheWriter::Finish() {
+    FUNCTION_CALL_DEBUG();
+
+    if (_fd < 0 || _finished) {
+        return AvError::CACHEWRITE;
+    }
+
+    _header.frame_count = _video_frames.load();
+    if (_header.frame_count == 0) {
+        return AvError::CACHEWRITE;
+    }
+
+    // Without timestamps both streams are taken to start together
+    const int64_t first_video_pts = _first_video_pts.load();
+    const int64_t first_audio_pts = _first_audio_pts.load();
+    _header.audio_start = 0;
+    if (first_video_pts != AV_NOPTS_VALUE && first_audio_pts != AV_NOPTS_VALUE) {
+        _header.audio_start = first_audio_pts - first_video_pts;
+    }
+
+    std::vector<uint32_t> index;
+    {
+        std::lock_guard<std::mutex> lock(_index_mutex);
+        index = _audio_samples;
+    }
+
+    // Keep the audio until it covers the last video frame. Audio that started ahead of the
+    // video needs that many more samples, anything past the end has nowhere to play.
+    const int64_t video_end = av_rescale(_header.frame_count, (int64_t)_header.sample_rate * _header.frame_rate_den, _header.frame_rate_num);
+    int64_t audio_end = _header.audio_start;
+    size_t audio_chunks = 0;
+    while (audio_chunks < index.size() && audio_end < video_end) {
+        audio_end += index[audio_chunks++];
+    }
+    index.resize(audio_chunks);
+
+    _header.audio_chunk_count = audio_chunks;
+    _header.index_offset = _header.data_offset + _header.record_size * std::max(_header.frame_count, _header.audio_chunk_count);
+
+    AvError err = _Write(index.data(), index.size() * sizeof(uint32_t), _header.index_offset);
+    if (err != AvError::NOERROR) {
+        return err;
+    }
+
+    // Dropped audio records may lie past the index
+    if (ftruncate(_fd, (off_t)(_header.index_offset + index.size() * sizeof(uint32_t))) != 0) {
+        return AvError::CACHEWRITE;
+    }
+
+    // The header goes last, a torn file never validates
+    err = _Write(&_header, sizeof(_header), 0);
+    if (err != AvError::NOERROR) {
+        return err;
+    }
+
+    if (close(_fd) != 0) {
+        _fd = -1;
+        return AvError::CACHEWRITE;
+    }
+    _fd = -1;
+
+    if (rename(_tmp_path.c_str(), _path.c_str()) != 0) {
+        ERROR("Failed to move %s into place: %s", _tmp_path.c_str(), strerror(errno));
+        return AvError::CACHEWRITE;
+    }
+
+    _finished = true;
+
+    DEBUG("Playout cache %s finished, %llu frames", _path.c_str(), (unsigned long long)_header.frame_count);
+
+    return AvError::NOERROR;
+}
+
+PlayoutCacheResult PlayoutCache::Open(const std::string &path) {
+    FUNCTION_CALL_DEBUG();
+
+    try {
+        return {std::shared_ptr<PlayoutCache>(new PlayoutCache(path)), AvError::NOERROR};
+    } catch (const AvException &e) {
+        DEBUG("Error opening playout cache: %s", e.what());
+        return {nullptr, e};
+    }
+}
+
+PlayoutCache::PlayoutCache(const std::string &path) : _path(path) {
+    FUNCTION_CALL_DEBUG();
+
+    AvError err = _Initialize();
+    if (err != AvError::NOERROR) {
+        throw AvException(err);
+    }
+}
+
+PlayoutCache::~PlayoutCache() {
+    FUNCTION_CALL_DEBUG();
+
+    if (_map) {
+        munmap(_map, _map_size);
+    }
+}
+
+AvError PlayoutCache::_Initialize() {
+    FUNCTION_CALL_DEBUG();
+
+    int fd = open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return AvError::CACHEOPEN;
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < PLAYOUTCACHE_PAGE_SIZE) {
+        close(fd);
+        return AvError::CACHEINVALID;
+    }
+
+    _map_size = (size_t)st.st_size;
+    void *map = mmap(nullptr, _map_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        return AvError::CACHEOPEN;
+    }
+    _map = (uint8_t *)map;
+
+    // Channels playing the same cache read the same pages, start pulling them in now
+    madvise(_map, _map_size, MADV_WILLNEED);
+
+    const PlayoutCacheHeader *header = (const PlayoutCacheHeader *)_map;
+    if (memcmp(header->magic, AVUTILS_PLAYOUTCACHE_MAGIC, sizeof(header->magic)) != 0 || header->version != AVUTILS_PLAYOUTCACHE_VERSION) {
+        return AvError::CACHEINVALID;
+    }
+
+    if (header->width <= 0 || header->height <= 0 || header->line_stride < header->width * 2 ||
+        header->frame_rate_num <= 0 || header->frame_rate_den <= 0 || header->sample_rate <= 0 ||
+        header->channels <= 0 || header->channels > AV_NUM_DATA_POINTERS || header->max_chunk_samples <= 0 || header->frame_count == 0) {
+        return AvError::CACHEINVALID;
+    }
+
+    if (VideoSize(*header) + AudioPlaneSize(*header) * header->channels > header->record_size ||
+        header->data_offset < sizeof(PlayoutCacheHeader) ||
+        header->index_offset != header->data_offset + header->record_size * std::max(header->frame_count, header->audio_chunk_count) ||
+        header->index_offset + header->audio_chunk_count * sizeof(uint32_t) > _map_size) {
+        return AvError::CACHEINVALID;
+    }
+
+    _header = header;
+    _audio_samples = (const uint32_t *)(_map + header->index_offset);
+
+    DEBUG("Mapped playout cache %s, %llu frames of %dx%d", _path.c_str(), (unsigned long long)header->frame_count, header->width, header->height);
+
+    return AvError::NOERROR;
+}
+
+AVBufferRef *PlayoutCache::_Reference(uint8_t *data, size_t size) {
+    // Each buffer keeps the mapping alive, whatever happens to the cache object meanwhile
+    auto *owner = new std::shared_ptr<PlayoutCache>(shared_from_this());
+
+    AVBufferRef *buffer = av_buffer_create(
+        data, size, [](void *opaque, uint8_t *) { delete (std::shared_ptr<PlayoutCache> *)opaque; }, owner, AV_BUFFER_FLAG_READONLY);
+    if (!buffer) {
+        delete owner;
+    }
+
+    return buffer;
+}
+
+FramePtr PlayoutCache::GetVideoFrame(int64_t index) {
+    FUNCTION_CALL_DEBUG();
+
+    if (index < 0 || index >= GetFrameCount()) {
+        return nullptr;
+    }
+
+    FramePtr frame(av_frame_alloc());
+    if (!frame) {
+        return nullptr;
+    }
+
+    uint8_t *data = _map + _header->data_offset + _header->record_size * index;
+
+    frame->buf[0] = _Reference(data, VideoSize(*_header));
+    if (!frame->buf[0]) {
+        return nullptr;
+    }
+
+    frame->data[0] = data;
+    frame->linesize[0] = _header->line_stride;
+    frame->format = AV_PIX_FMT_UYVY422;
+    frame->width = _header->width;
+    frame->height = _header->height;
+
+    return frame;
+}
+
+FramePtr PlayoutCache::GetAudioFrame(int64_t index) {
+    FUNCTION_CALL_DEBUG();
+
+    if (index < 0 || index >= GetAudioChunkCount() || _audio_samples[index] == 0 || _audio_samples[index] > (uint32_t)_header->max_chunk_samples) {
+        return nullptr;
+    }
+
+    FramePtr frame(av_frame_alloc());
+    if (!frame) {
+        return nullptr;
+    }
+
+    uint8_t *data = _map + _header->data_offset + _header->record_size * index + VideoSize(*_header);
+
+    frame->buf[0] = _Reference(data, AudioPlaneSize(*_header) * _header->channels);
+    if (!frame->buf[0]) {
+        return nullptr;
+    }
+
+    // Planes are evenly spaced, they go out to NDI without repacking
+    for (int c = 0; c < _header->channels; c++) {
+        frame->data[c] = data + AudioPlaneSize(*_header) * c;
+    }
+    frame->extended_data = frame->data;
+    frame->linesize[0] = (int)AudioPlaneSize(*_header);
+    frame->format = AV_SAMPLE_FMT_FLTP;
+    frame->sample_rate = _header->sample_rate;
+    frame->nb_samples = (int)_audio_samples[index];
+    av_channel_layout_default(&frame->ch_layout, _header->channels);
+
+    return frame;
+}
+
+} // namespace AV::Utils
@@ -0,0 +1,188 @@
+/**
+ * @file playoutcache.hpp
+ * @brief Pre-decoded, memory mapped playout cache of NDI ready frames
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#pragma once
+
+// Local includes
+#include "averror.hpp"
+#include "frame.hpp"
+
+// 3rd Party Dependencies
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/rational.h>
+}
+
+// Standard C++ Dependencies
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define AVUTILS_PLAYOUTCACHE_MAGIC "NDICACHE"
+#define AVUTILS_PLAYOUTCACHE_VERSION 3
+
+namespace AV::Utils {
+
+/**
+ * @brief First page of a cache file. Records of one video frame and the audio that plays
+ * alongside it follow, each starting on a page boundary. The audio sample count of every
+ * record is stored as a uint32_t array at index_offset. Audio plays back to back from
+ * audio_start, so streams that did not start together keep their offset. Audio that
+ * started ahead of the video runs past the last frame, those records hold audio only.
+ */
+typedef struct PlayoutCacheHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t width, height;
+    int32_t line_stride;         // UYVY bytes per row
+    int32_t frame_rate_num, frame_rate_den;
+    int32_t sample_rate, channels;
+    int32_t max_chunk_samples;   // Float planar, every channel gets room for this many samples
+    uint64_t frame_count;
+    uint64_t record_size;
+    uint64_t data_offset;
+    uint64_t index_offset;
+    int64_t audio_start;         // First audio sample relative to video frame 0, in samples
+    uint64_t audio_chunk_count;  // Records holding audio, may be more than frame_count
+} PlayoutCacheHeader;
+
+/**
+ * @brief What goes into a cache, taken from the source before its first frame is decoded
+ */
+typedef struct PlayoutCacheFormat {
+    int width{}, height{};
+    AVRational frame_rate{};
+    int sample_rate{};
+    int channels{};
+} PlayoutCacheFormat;
+
+/**
+ * @brief Where the cache of a media file lives. The name carries the size and modification
+ * time of the file, so a changed file never plays from a stale cache.
+ *
+ * @param cache_dir Directory holding the caches
+ * @param path The media file
+ * @return std::string The cache path, empty if the media file can't be stat'ed
+ */
+std::string PlayoutCachePath(const std::string &cache_dir, const std::string &path);
+
+// Forward declarations and type definitions
+class PlayoutCacheWriter;
+class PlayoutCache;
+using PlayoutCacheWriterResult = std::pair<std::unique_ptr<PlayoutCacheWriter>, const AvException>;
+using PlayoutCacheResult = std::pair<std::shared_ptr<PlayoutCache>, const AvException>;
+
+/**
+ * @brief Writes UYVY video and float planar audio into a cache file as it is played out.
+ *
+ * Video frame k and audio chunk k go into record k, so AddVideo() and AddAudio() may be
+ * called from different threads. The pts of the first frame and chunk give the audio start. The file is written under a temporary name and only
+ * renamed into place by Finish(), a writer destroyed before that leaves nothing behind.
+ */
+class PlayoutCacheWriter {
+private:
+    PlayoutCacheWriter(const std::string &path, const PlayoutCacheFormat &format);
+    AvError _Initialize();
+    AvError _Write(const void *data, size_t size, uint64_t offset);
+
+public:
+    ~PlayoutCacheWriter();
+
+    PlayoutCacheWriter(const PlayoutCacheWriter &) = delete;
+    PlayoutCacheWriter &operator=(const PlayoutCacheWriter &) = delete;
+
+    // Factory
+    static PlayoutCacheWriterResult Create(const std::string &path, const PlayoutCacheFormat &format);
+
+    /**
+     * @brief Store the next video frame, it has to be UYVY at the cache's size
+     */
+    AvException AddVideo(const AVFrame *frame);
+
+    /**
+     * @brief Store the next audio chunk, float planar of at most one video frame period
+     */
+    AvException AddAudio(const AVFrame *frame);
+
+    /**
+     * @brief Write the index and header and move the file into place
+     */
+    AvException Finish();
+
+private:
+    std::string _path;
+    std::string _tmp_path;
+    PlayoutCacheHeader _header{};
+
+    int _fd = -1;
+    bool _finished = false;
+
+    std::atomic<uint64_t> _video_frames{0};
+    std::atomic<uint64_t> _audio_chunks{0};
+
+    // pts of the first frame and chunk in samples, read by Finish() once both streams are done
+    std::atomic<int64_t> _first_video_pts{AV_NOPTS_VALUE};
+    std::atomic<int64_t> _first_audio_pts{AV_NOPTS_VALUE};
+
+    std::mutex _index_mutex;
+    std::vector<uint32_t> _audio_samples;
+};
+
+/**
+ * @brief A finished cache file mapped into memory.
+ *
+ * Frames point straight into the mapping, nothing is decoded or copied on the way to NDI,
+ * and every process playing the same cache shares the page cache. The frames hold a
+ * reference to the cache, so it stays mapped until the last one is freed.
+ */
+class PlayoutCache : public std::enable_shared_from_this<PlayoutCache> {
+private:
+    PlayoutCache(const std::string &path);
+    AvError _Initialize();
+
+public:
+    ~PlayoutCache();
+
+    PlayoutCache(const PlayoutCache &) = delete;
+    PlayoutCache &operator=(const PlayoutCache &) = delete;
+
+    // Factory
+    static PlayoutCacheResult Open(const std::string &path);
+
+    const PlayoutCacheHeader &GetHeader() const { return *_header; }
+    int64_t GetFrameCount() const { return (int64_t)_header->frame_count; }
+    AVRational GetFrameRate() const { return {_header->frame_rate_num, _header->frame_rate_den}; }
+    int64_t GetAudioStart() const { return _header->audio_start; }
+    int64_t GetAudioChunkCount() const { return (int64_t)_header->audio_chunk_count; }
+
+    /**
+     * @brief Video frame index, UYVY without pts or time base
+     */
+    FramePtr GetVideoFrame(int64_t index);
+
+    /**
+     * @brief Audio chunk index, float planar without pts or time base. Null if the record
+     * holds no audio. Chunks past GetFrameCount() play on after the last video frame.
+     */
+    FramePtr GetAudioFrame(int64_t index);
+
+private:
+    AVBufferRef *_Reference(uint8_t *data, size_t size);
+
+    std::string _path;
+    uint8_t *_map = nullptr;
+    size_t _map_size = 0;
+    const PlayoutCacheHeader *_header = nullptr;
+    const uint32_t *_audio_samples = nullptr;
+};
+
+} // namespace AV::Utils
@@ -9,6 +9,7 @@
 #pragma once
 
 #include "averror.hpp"
+#include "frame.hpp"
 
 extern "C" {
 #include <libavfilter/avfilter.h>
@@ -21,13 +22,12 @@ extern "C" {
 
 #include <string>
 #include <memory>
-#include <vector>
 
 namespace AV::Utils {
 
 class SimpleFilter;
 using SimpleFilterResult = std::pair<std::unique_ptr<SimpleFilter>, const AvException>;
-using SimpleFilterOutput = std::pair<std::vector<AVFrame *>, const AvException>;
+using SimpleFilterOutput = std::pair<AVFrame *, const AvException>;
 
 class SimpleFilter {
 private:
@@ -45,13 +45,32 @@ public:
     static SimpleFilterResult CreateFilter(const std::string &filter_description, const AVCodecParameters *codec_parameters, const AVRational &time_base);
 
     // Filter methods
-    SimpleFilterOutput FilterFrame(AVFrame *frame);
+    /**
+     * @brief Push a frame into the filter graph
+     *
+     * @param frame The frame to filter, the graph takes ownership of it. A null frame flushes the graph.
+     * @return AvException
+     */
+    AvException FillFilter(FramePtr &&frame);
+
+    /**
+     * @brief Pull the next filtered frame. If the graph needs another frame, it will return
+     * an error code of FILTEREXHAUSTED
+     *
+     * The frame is owned by the filter and stays valid until the next call.
+     *
+     * @return SimpleFilterOutput
+     */
+    SimpleFilterOutput FilterFrame();
 
 private:
     AVFilterGraph *_filter_graph = nullptr;
 
     AVFilterContext *_buffersrc_ctx = nullptr;
     AVFilterContext *_buffersink_ctx = nullptr;
+
+    // Reused for every filtered frame
+    AVFrame *_filtered_frame = nullptr;
 };
 
 } // namespace AV::Utils
\ No newline at end of file
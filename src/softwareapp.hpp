@@ -10,19 +10,9 @@
 
 // Local includes
 #include "averror.hpp"
-#include "demuxer.hpp"
-#include "asyncndisource.hpp"
-#include "simplefilter.hpp"
-#include "decoder.hpp"
-#include "pixelencoder.hpp"
-#include "audioresampler.hpp"
-#include "frametimer.hpp"
+#include "pipelinepolicies.hpp"
 #include "app.hpp"
 
-extern "C" {
-	#include <libavcodec/codec_par.h>
-}
-
 // Standard C++ includes
 #include <string>
 #include <memory>
@@ -32,29 +22,18 @@ using SoftwareAppResult = std::pair<std::shared_ptr<SoftwareApp>, AV::Utils::AvE
 
 class SoftwareApp : public App {
 private:
-	SoftwareApp(const std::string &ndi_source_name, const std::string &video_file_path);
+	SoftwareApp(const AV::Utils::PipelineConfig &config);
 	AV::Utils::AvError _Initialize();
 
 public:
 	~SoftwareApp() = default;
 
 	// Factory
-	static SoftwareAppResult Create(const std::string &ndi_source_name, const std::string &video_file_path);
+	static SoftwareAppResult Create(const AV::Utils::PipelineConfig &config);
 
 	AV::Utils::AvException Run() override;
 
 private:
-	std::string _ndi_source_name;
-	std::string _video_file_path;
-	std::shared_ptr<AV::Utils::Demuxer> _demuxer;
-	std::shared_ptr<AV::Utils::Decoder> _audio_decoder;
-	std::shared_ptr<AV::Utils::Decoder> _video_decoder;
-	std::shared_ptr<AV::Utils::AudioResampler> _audio_resampler;
-	std::shared_ptr<AV::Utils::AsyncNDISource> _ndi_source;
-	std::shared_ptr<AV::Utils::SimpleFilter> _simple_filter;
-	
-	AV::Utils::FrameTimer _frame_timer;
-
-	int _video_stream_index = -1;
-	int _audio_stream_index = -1;
+	AV::Utils::PipelineConfig _config;
+	std::unique_ptr<AV::Utils::SoftwarePipeline> _pipeline;
 };
\ No newline at end of file
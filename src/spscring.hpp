@@ -0,0 +1,192 @@
+/**
+ * @file spscring.hpp
+ * @brief Lock-free single producer / single consumer ring buffer
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#pragma once
+
+// Standard C++ Dependencies
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// Defines
+#define AVUTILS_CACHE_LINE_SIZE 64
+
+namespace AV::Utils {
+
+/**
+ * @brief Fixed size ring buffer for exactly one producer thread and one consumer thread.
+ *
+ * Indices are free running 32 bit counters on their own cache lines, the producer
+ * only writes _tail and the consumer only writes _head. Each side keeps a private
+ * copy of the other side's index so the shared line is only touched when the cached
+ * value says the ring looks full (or empty).
+ *
+ * Blocking calls sleep on an event counter with std::atomic::wait, which is a futex
+ * on Linux. The other side bumps the counter after every publish, so a sleeper wakes
+ * up the moment data or space shows up and nobody ever polls.
+ */
+template <typename T, size_t Capacity>
+class SPSCRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SPSCRing capacity must be a power of two");
+
+public:
+    SPSCRing() = default;
+
+    SPSCRing(const SPSCRing &) = delete;
+    SPSCRing &operator=(const SPSCRing &) = delete;
+
+    /**
+     * @brief Push an item if there is room. Producer thread only.
+     *
+     * @param item The item to push, left untouched on failure
+     * @return bool False if the ring is full
+     */
+    bool TryPush(T &item) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+
+        if (tail - _producer_cached_head == Capacity) {
+            _producer_cached_head = _head.load(std::memory_order_acquire);
+            if (tail - _producer_cached_head == Capacity) {
+                return false;
+            }
+        }
+
+        _slots[tail & (Capacity - 1)] = std::move(item);
+        _tail.store(tail + 1, std::memory_order_release);
+
+        _data_event.fetch_add(1, std::memory_order_release);
+        _data_event.notify_one();
+
+        return true;
+    }
+
+    /**
+     * @brief Push an item, sleeping while the ring is full. Producer thread only.
+     *
+     * @param item The item to push, left untouched on failure
+     * @return bool False if the ring was closed
+     */
+    bool Push(T &item) {
+        while (true) {
+            if (_closed.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            if (TryPush(item)) {
+                return true;
+            }
+
+            // Sample the event before re-checking so a wakeup in between is not lost
+            uint32_t event = _space_event.load(std::memory_order_acquire);
+            if (TryPush(item)) {
+                return true;
+            }
+
+            if (_closed.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            _space_event.wait(event, std::memory_order_acquire);
+        }
+    }
+
+    /**
+     * @brief Pop an item if one is available. Consumer thread only.
+     *
+     * @param item Receives the popped item
+     * @return bool False if the ring is empty
+     */
+    bool TryPop(T &item) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+
+        if (head == _consumer_cached_tail) {
+            _consumer_cached_tail = _tail.load(std::memory_order_acquire);
+            if (head == _consumer_cached_tail) {
+                return false;
+            }
+        }
+
+        item = std::move(_slots[head & (Capacity - 1)]);
+        _head.store(head + 1, std::memory_order_release);
+
+        _space_event.fetch_add(1, std::memory_order_release);
+        _space_event.notify_one();
+
+        return true;
+    }
+
+    /**
+     * @brief Pop an item, sleeping while the ring is empty. Consumer thread only.
+     *
+     * @param item Receives the popped item
+     * @return bool False once the ring is closed and drained
+     */
+    bool Pop(T &item) {
+        while (true) {
+            if (TryPop(item)) {
+                return true;
+            }
+
+            // Sample the event before re-checking so a wakeup in between is not lost
+            uint32_t event = _data_event.load(std::memory_order_acquire);
+            if (TryPop(item)) {
+                return true;
+            }
+
+            if (_closed.load(std::memory_order_acquire)) {
+                return TryPop(item);
+            }
+
+            _data_event.wait(event, std::memory_order_acquire);
+        }
+    }
+
+    /**
+     * @brief Close the ring. Blocked producers give up, the consumer drains what is left.
+     * Safe to call from any thread.
+     */
+    void Close() {
+        _closed.store(true, std::memory_order_release);
+
+        _data_event.fetch_add(1, std::memory_order_release);
+        _data_event.notify_all();
+        _space_event.fetch_add(1, std::memory_order_release);
+        _space_event.notify_all();
+    }
+
+    /**
+     * @brief Approximate number of items in the ring
+     */
+    size_t Size() const {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+
+    bool IsEmpty() const {
+        return Size() == 0;
+    }
+
+private:
+    // Consumer side
+    alignas(AVUTILS_CACHE_LINE_SIZE) std::atomic<uint32_t> _head{0};
+    uint32_t _consumer_cached_tail = 0;
+
+    // Producer side
+    alignas(AVUTILS_CACHE_LINE_SIZE) std::atomic<uint32_t> _tail{0};
+    uint32_t _producer_cached_head = 0;
+
+    // Wakeup counters, bumped after every publish
+    alignas(AVUTILS_CACHE_LINE_SIZE) std::atomic<uint32_t> _data_event{0};
+    alignas(AVUTILS_CACHE_LINE_SIZE) std::atomic<uint32_t> _space_event{0};
+
+    alignas(AVUTILS_CACHE_LINE_SIZE) std::atomic<bool> _closed{false};
+
+    alignas(AVUTILS_CACHE_LINE_SIZE) T _slots[Capacity];
+};
+
+} // namespace AV::Utils
@@ -0,0 +1,310 @@
+/**
+ * @file streaminfocache.cpp
+ * @brief Sidecar cache of the stream info libavformat probes from a media file
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include "streaminfocache.hpp"
+#include "macro.hpp"
+
+extern "C" {
+#include <libavutil/channel_layout.h>
+#include <libavutil/mem.h>
+}
+
+// POSIX includes
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Standard C++ Dependencies
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <thread>
+#include <vector>
+
+namespace AV::Utils {
+
+// A sidecar is this header, the media path, then a record and its extradata per stream
+typedef struct StreamInfoHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nb_streams;
+    int64_t file_size;
+    int64_t mtime_sec, mtime_nsec;
+    int64_t start_time, duration;
+    uint32_t path_size;
+    uint32_t reserved;
+} StreamInfoHeader;
+
+typedef struct StreamInfoRecord {
+    // Codec parameters
+    int32_t codec_type, codec_id;
+    uint32_t codec_tag;
+    int32_t format;
+    int64_t bit_rate;
+    int32_t bits_per_coded_sample, bits_per_raw_sample;
+    int32_t profile, level;
+    int32_t width, height;
+    int32_t sample_aspect_ratio_num, sample_aspect_ratio_den;
+    int32_t framerate_num, framerate_den;
+    int32_t field_order, color_range, color_primaries, color_trc, color_space, chroma_location;
+    int32_t video_delay;
+    int32_t ch_order, nb_channels;
+    uint64_t ch_mask;
+    int32_t sample_rate, block_align, frame_size;
+    int32_t initial_padding, trailing_padding, seek_preroll;
+
+    // Stream
+    int32_t time_base_num, time_base_den;
+    int64_t start_time, duration, nb_frames;
+    int32_t avg_frame_rate_num, avg_frame_rate_den;
+    int32_t r_frame_rate_num, r_frame_rate_den;
+
+    int32_t extradata_size;
+    int32_t reserved;
+} StreamInfoRecord;
+
+// Identify the media file as it is now, a sidecar only applies to the very same file
+static bool StatMedia(const std::string &path, StreamInfoHeader &header) {
+    struct stat st {};
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+
+    header.file_size = st.st_size;
+    header.mtime_sec = st.st_mtim.tv_sec;
+    header.mtime_nsec = st.st_mtim.tv_nsec;
+
+    return true;
+}
+
+std::string StreamInfoCachePath(const std::string &cache_dir, const std::string &path) {
+    FUNCTION_CALL_DEBUG();
+
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)std::hash<std::string>{}(path));
+
+    return (std::filesystem::path(cache_dir) / (std::filesystem::path(path).filename().string() + "." + hash + ".streaminfo")).string();
+}
+
+AvException LoadStreamInfo(const std::string &cache_path, const std::string &path, AVFormatContext *format_ctx) {
+    FUNCTION_CALL_DEBUG();
+
+    std::ifstream file(cache_path, std::ios::binary);
+    if (!file.is_open()) {
+        return AvError::CACHEOPEN;
+    }
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    StreamInfoHeader header{}, media{};
+    if (data.size() < sizeof(header) || !StatMedia(path, media)) {
+        return AvError::CACHEINVALID;
+    }
+
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.magic, AVUTILS_STREAMINFO_MAGIC, sizeof(header.magic)) != 0 || header.version != AVUTILS_STREAMINFO_VERSION ||
+        header.file_size != media.file_size || header.mtime_sec != media.mtime_sec || header.mtime_nsec != media.mtime_nsec ||
+        header.nb_streams != format_ctx->nb_streams || header.path_size != path.size() ||
+        data.size() < sizeof(header) + path.size() || memcmp(data.data() + sizeof(header), path.data(), path.size()) != 0) {
+        return AvError::CACHEINVALID;
+    }
+
+    // Check every stream before touching any of them
+    std::vector<StreamInfoRecord> records(header.nb_streams);
+    std::vector<const uint8_t *> extradata(header.nb_streams);
+
+    size_t offset = sizeof(header) + path.size();
+    for (uint32_t i = 0; i < header.nb_streams; i++) {
+        if (data.size() - offset < sizeof(StreamInfoRecord)) {
+            return AvError::CACHEINVALID;
+        }
+
+        StreamInfoRecord &record = records[i];
+        memcpy(&record, data.data() + offset, sizeof(record));
+        offset += sizeof(record);
+
+        if (record.extradata_size < 0 || data.size() - offset < (size_t)record.extradata_size) {
+            return AvError::CACHEINVALID;
+        }
+
+        extradata[i] = data.data() + offset;
+        offset += record.extradata_size;
+
+        // What the demuxer found while opening has to agree with the sidecar
+        const AVStream *stream = format_ctx->streams[i];
+        const AVCodecParameters *codecpar = stream->codecpar;
+        if ((codecpar->codec_type != AVMEDIA_TYPE_UNKNOWN && codecpar->codec_type != record.codec_type) ||
+            (codecpar->codec_id != AV_CODEC_ID_NONE && codecpar->codec_id != record.codec_id) ||
+            stream->time_base.num != record.time_base_num || stream->time_base.den != record.time_base_den) {
+            return AvError::CACHEINVALID;
+        }
+    }
+
+    for (uint32_t i = 0; i < header.nb_streams; i++) {
+        const StreamInfoRecord &record = records[i];
+        AVStream *stream = format_ctx->streams[i];
+        AVCodecParameters *codecpar = stream->codecpar;
+
+        if (record.extradata_size > 0) {
+            uint8_t *buffer = (uint8_t *)av_mallocz(record.extradata_size + AV_INPUT_BUFFER_PADDING_SIZE);
+            if (buffer == nullptr) {
+                return AvError::CACHEINVALID;
+            }
+
+            memcpy(buffer, extradata[i], record.extradata_size);
+            av_freep(&codecpar->extradata);
+            codecpar->extradata = buffer;
+            codecpar->extradata_size = record.extradata_size;
+        }
+
+        codecpar->codec_type = (AVMediaType)record.codec_type;
+        codecpar->codec_id = (AVCodecID)record.codec_id;
+        codecpar->codec_tag = record.codec_tag;
+        codecpar->format = record.format;
+        codecpar->bit_rate = record.bit_rate;
+        codecpar->bits_per_coded_sample = record.bits_per_coded_sample;
+        codecpar->bits_per_raw_sample = record.bits_per_raw_sample;
+        codecpar->profile = record.profile;
+        codecpar->level = record.level;
+        codecpar->width = record.width;
+        codecpar->height = record.height;
+        codecpar->sample_aspect_ratio = {record.sample_aspect_ratio_num, record.sample_aspect_ratio_den};
+        codecpar->framerate = {record.framerate_num, record.framerate_den};
+        codecpar->field_order = (AVFieldOrder)record.field_order;
+        codecpar->color_range = (AVColorRange)record.color_range;
+        codecpar->color_primaries = (AVColorPrimaries)record.color_primaries;
+        codecpar->color_trc = (AVColorTransferCharacteristic)record.color_trc;
+        codecpar->color_space = (AVColorSpace)record.color_space;
+        codecpar->chroma_location = (AVChromaLocation)record.chroma_location;
+        codecpar->video_delay = record.video_delay;
+        codecpar->sample_rate = record.sample_rate;
+        codecpar->block_align = record.block_align;
+        codecpar->frame_size = record.frame_size;
+        codecpar->initial_padding = record.initial_padding;
+        codecpar->trailing_padding = record.trailing_padding;
+        codecpar->seek_preroll = record.seek_preroll;
+
+        av_channel_layout_uninit(&codecpar->ch_layout);
+        if (record.ch_order == AV_CHANNEL_ORDER_NATIVE) {
+            av_channel_layout_from_mask(&codecpar->ch_layout, record.ch_mask);
+        } else {
+            codecpar->ch_layout.order = AV_CHANNEL_ORDER_UNSPEC;
+            codecpar->ch_layout.nb_channels = record.nb_channels;
+        }
+
+        stream->start_time = record.start_time;
+        stream->duration = record.duration;
+        stream->nb_frames = record.nb_frames;
+        stream->avg_frame_rate = {record.avg_frame_rate_num, record.avg_frame_rate_den};
+        stream->r_frame_rate = {record.r_frame_rate_num, record.r_frame_rate_den};
+    }
+
+    format_ctx->start_time = header.start_time;
+    format_ctx->duration = header.duration;
+
+    return AvError::NOERROR;
+}
+
+AvException StoreStreamInfo(const std::string &cache_path, const std::string &path, const AVFormatContext *format_ctx) {
+    FUNCTION_CALL_DEBUG();
+
+    StreamInfoHeader header{};
+    if (!StatMedia(path, header)) {
+        return AvError::CACHEWRITE;
+    }
+
+    memcpy(header.magic, AVUTILS_STREAMINFO_MAGIC, sizeof(header.magic));
+    header.version = AVUTILS_STREAMINFO_VERSION;
+    header.nb_streams = format_ctx->nb_streams;
+    header.start_time = format_ctx->start_time;
+    header.duration = format_ctx->duration;
+    header.path_size = (uint32_t)path.size();
+
+    std::vector<uint8_t> data(sizeof(header));
+    memcpy(data.data(), &header, sizeof(header));
+    data.insert(data.end(), path.begin(), path.end());
+
+    for (unsigned int i = 0; i < format_ctx->nb_streams; i++) {
+        const AVStream *stream = format_ctx->streams[i];
+        const AVCodecParameters *codecpar = stream->codecpar;
+
+        // Custom channel maps don't fit in a mask, those files are probed every time
+        if (codecpar->ch_layout.order != AV_CHANNEL_ORDER_NATIVE && codecpar->ch_layout.order != AV_CHANNEL_ORDER_UNSPEC) {
+            return AvError::CACHEINVALID;
+        }
+
+        StreamInfoRecord record{};
+        record.codec_type = codecpar->codec_type;
+        record.codec_id = codecpar->codec_id;
+        record.codec_tag = codecpar->codec_tag;
+        record.format = codecpar->format;
+        record.bit_rate = codecpar->bit_rate;
+        record.bits_per_coded_sample = codecpar->bits_per_coded_sample;
+        record.bits_per_raw_sample = codecpar->bits_per_raw_sample;
+        record.profile = codecpar->profile;
+        record.level = codecpar->level;
+        record.width = codecpar->width;
+        record.height = codecpar->height;
+        record.sample_aspect_ratio_num = codecpar->sample_aspect_ratio.num;
+        record.sample_aspect_ratio_den = codecpar->sample_aspect_ratio.den;
+        record.framerate_num = codecpar->framerate.num;
+        record.framerate_den = codecpar->framerate.den;
+        record.field_order = codecpar->field_order;
+        record.color_range = codecpar->color_range;
+        record.color_primaries = codecpar->color_primaries;
+        record.color_trc = codecpar->color_trc;
+        record.color_space = codecpar->color_space;
+        record.chroma_location = codecpar->chroma_location;
+        record.video_delay = codecpar->video_delay;
+        record.ch_order = codecpar->ch_layout.order;
+        record.nb_channels = codecpar->ch_layout.nb_channels;
+        record.ch_mask = codecpar->ch_layout.order == AV_CHANNEL_ORDER_NATIVE ? codecpar->ch_layout.u.mask : 0;
+        record.sample_rate = codecpar->sample_rate;
+        record.block_align = codecpar->block_align;
+        record.frame_size = codecpar->frame_size;
+        record.initial_padding = codecpar->initial_padding;
+        record.trailing_padding = codecpar->trailing_padding;
+        record.seek_preroll = codecpar->seek_preroll;
+
+        record.time_base_num = stream->time_base.num;
+        record.time_base_den = stream->time_base.den;
+        record.start_time = stream->start_time;
+        record.duration = stream->duration;
+        record.nb_frames = stream->nb_frames;
+        record.avg_frame_rate_num = stream->avg_frame_rate.num;
+        record.avg_frame_rate_den = stream->avg_frame_rate.den;
+        record.r_frame_rate_num = stream->r_frame_rate.num;
+        record.r_frame_rate_den = stream->r_frame_rate.den;
+        record.extradata_size = codecpar->extradata != nullptr ? codecpar->extradata_size : 0;
+
+        const uint8_t *bytes = (const uint8_t *)&record;
+        data.insert(data.end(), bytes, bytes + sizeof(record));
+        if (record.extradata_size > 0) {
+            data.insert(data.end(), codecpar->extradata, codecpar->extradata + record.extradata_size);
+        }
+    }
+
+    // Written aside and moved into place, a reader never sees half a sidecar. Channels of one
+    // process may open the same file at once, each writes its own.
+    std::string tmp_path = cache_path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+    std::ofstream file(tmp_path, std::ios::binary | std::ios::trunc);
+    file.write((const char *)data.data(), (std::streamsize)data.size());
+    file.close();
+
+    if (!file || rename(tmp_path.c_str(), cache_path.c_str()) != 0) {
+        unlink(tmp_path.c_str());
+        return AvError::CACHEWRITE;
+    }
+
+    return AvError::NOERROR;
+}
+
+} // namespace AV::Utils
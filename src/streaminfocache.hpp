@@ -0,0 +1,60 @@
+/**
+ * @file streaminfocache.hpp
+ * @brief Sidecar cache of the stream info libavformat probes from a media file
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#pragma once
+
+// Local includes
+#include "averror.hpp"
+
+// 3rd Party Dependencies
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+// Standard C++ Dependencies
+#include <string>
+
+#define AVUTILS_STREAMINFO_MAGIC "NDIPROBE"
+#define AVUTILS_STREAMINFO_VERSION 1
+
+namespace AV::Utils {
+
+/**
+ * @brief Where the stream info of a media file is cached
+ *
+ * @param cache_dir Directory holding the sidecars
+ * @param path The media file
+ * @return std::string The sidecar path
+ */
+std::string StreamInfoCachePath(const std::string &cache_dir, const std::string &path);
+
+/**
+ * @brief Fill in the streams of a format context that was opened but not probed.
+ *
+ * The sidecar has to belong to the same file, at the same size and modification time,
+ * and list the same streams with the same codecs the demuxer found while opening.
+ * Nothing is changed unless all of that holds.
+ *
+ * @param cache_path The sidecar
+ * @param path The media file
+ * @param format_ctx Opened with avformat_open_input(), without avformat_find_stream_info()
+ * @return AvException CACHEOPEN if there is no sidecar, CACHEINVALID if it does not match
+ */
+AvException LoadStreamInfo(const std::string &cache_path, const std::string &path, AVFormatContext *format_ctx);
+
+/**
+ * @brief Save the stream info of a probed format context for the next open
+ *
+ * @param cache_path The sidecar
+ * @param path The media file
+ * @param format_ctx Probed with avformat_find_stream_info()
+ * @return AvException
+ */
+AvException StoreStreamInfo(const std::string &cache_path, const std::string &path, const AVFormatContext *format_ctx);
+
+} // namespace AV::Utils
@@ -0,0 +1,149 @@
+/**
+ * @file threadpool.cpp
+ * @brief Shared worker pool for data parallel work
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include "threadpool.hpp"
+#include "macro.hpp"
+
+#include <algorithm>
+
+namespace AV::Utils {
+
+// Priority of the loops each thread starts
+static thread_local int t_priority = 0;
+
+ThreadPool::ThreadPool(size_t threads) {
+    FUNCTION_CALL_DEBUG();
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    DEBUG("Thread pool size: %lu", threads);
+
+    for (size_t i = 1; i < threads; i++) {
+        _workers.emplace_back(&ThreadPool::_Thread_Worker, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    FUNCTION_CALL_DEBUG();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _stop = true;
+    lock.unlock();
+
+    _job_available.notify_all();
+    for (auto &worker : _workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::SetPriority(int priority) {
+    t_priority = priority;
+}
+
+void ThreadPool::_RunJob(Job &job, bool yield) {
+    for (size_t i = job.next.fetch_add(1, std::memory_order_relaxed); i < job.count; i = job.next.fetch_add(1, std::memory_order_relaxed)) {
+        (*job.fn)(i);
+
+        // A worker moves on to more urgent work, the caller is still there to finish this
+        if (yield && _top_priority.load(std::memory_order_relaxed) > job.priority) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::_RemoveJob(Job &job) {
+    auto it = std::find(_jobs.begin(), _jobs.end(), &job);
+    if (it == _jobs.end()) {
+        return;
+    }
+
+    _jobs.erase(it);
+
+    int top_priority = INT_MIN;
+    for (Job *queued : _jobs) {
+        top_priority = std::max(top_priority, queued->priority);
+    }
+
+    _top_priority.store(top_priority, std::memory_order_relaxed);
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)> &fn) {
+    if (count == 0) {
+        return;
+    }
+
+    // Nothing to share
+    if (count == 1 || _workers.empty()) {
+        for (size_t i = 0; i < count; i++) {
+            fn(i);
+        }
+
+        return;
+    }
+
+    Job job;
+    job.fn = &fn;
+    job.count = count;
+    job.priority = t_priority;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _jobs.push_back(&job);
+    if (job.priority > _top_priority.load(std::memory_order_relaxed)) {
+        _top_priority.store(job.priority, std::memory_order_relaxed);
+    }
+    lock.unlock();
+
+    _job_available.notify_all();
+
+    _RunJob(job, false);
+
+    // Every iteration is claimed, stop handing the job out and wait for the workers still on it
+    lock.lock();
+    _RemoveJob(job);
+
+    _job_released.wait(lock, [&job] { return job.active_workers == 0; });
+}
+
+void ThreadPool::_Thread_Worker() {
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true) {
+        _job_available.wait(lock, [this] { return _stop || !_jobs.empty(); });
+        if (_stop) {
+            return;
+        }
+
+        // Highest priority first, the oldest of those on a tie
+        Job *job = _jobs.front();
+        for (Job *queued : _jobs) {
+            if (queued->priority > job->priority) {
+                job = queued;
+            }
+        }
+
+        job->active_workers++;
+        lock.unlock();
+
+        _RunJob(*job, true);
+
+        lock.lock();
+
+        // Once the job is done handing out iterations, make sure nobody else picks it up
+        if (job->next.load(std::memory_order_relaxed) >= job->count) {
+            _RemoveJob(*job);
+        }
+
+        if (--job->active_workers == 0) {
+            _job_released.notify_all();
+        }
+    }
+}
+
+} // namespace AV::Utils
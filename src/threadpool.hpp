@@ -0,0 +1,97 @@
+/**
+ * @file threadpool.hpp
+ * @brief Shared worker pool for data parallel work
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#pragma once
+
+// Standard C++ Dependencies
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Rows per band are sized so a band of output stays within this many bytes
+#define AVUTILS_BAND_BYTES (256 * 1024)
+
+// Work split into bands that each need their own state is capped at this many bands per pool thread
+#define AVUTILS_BANDS_PER_THREAD 2
+
+namespace AV::Utils {
+
+/**
+ * @brief A fixed set of worker threads that split ParallelFor() loops between them.
+ *
+ * The calling thread always works on its own loop too, so a pool of N threads runs
+ * loops N wide with N - 1 workers. Several threads, or several pipelines sharing one
+ * pool, may call ParallelFor() at once. Workers help out on the loop with the highest
+ * priority, the oldest of those first, and leave a loop between iterations as soon as
+ * one with a higher priority is waiting. The caller finishes its own loop regardless.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Construct a new ThreadPool object
+     *
+     * @param threads How many threads run a loop, including the caller. 0 uses every core.
+     */
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Run fn(0) ... fn(count - 1) across the pool and wait for all of them
+     *
+     * @param count Number of iterations
+     * @param fn Called once per iteration, from any thread in the pool
+     */
+    void ParallelFor(size_t count, const std::function<void(size_t)> &fn);
+
+    /**
+     * @brief Set the priority of loops started by the calling thread, higher goes first
+     *
+     * @param priority Priority of every ParallelFor() this thread calls from now on
+     */
+    static void SetPriority(int priority);
+
+    /**
+     * @brief How many threads run a loop, including the caller
+     */
+    size_t GetThreadCount() const { return _workers.size() + 1; }
+
+private:
+    struct Job {
+        const std::function<void(size_t)> *fn;
+        size_t count;
+        std::atomic<size_t> next{0};
+        size_t active_workers = 0;
+        int priority = 0;
+    };
+
+    void _Thread_Worker();
+    void _RunJob(Job &job, bool yield);
+    void _RemoveJob(Job &job);
+
+    std::mutex _mutex;
+    std::condition_variable _job_available;
+    std::condition_variable _job_released;
+    std::deque<Job *> _jobs;
+    bool _stop = false;
+
+    // Highest priority of the queued jobs, read by workers between iterations
+    std::atomic<int> _top_priority{INT_MIN};
+
+    std::vector<std::thread> _workers;
+};
+
+} // namespace AV::Utils
@@ -0,0 +1,387 @@
+/**
+ * @file uyvyconverter.cpp
+ * @brief Vectorized packing of decoded video into NDI's native UYVY
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include "uyvyconverter.hpp"
+#include "macro.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define AVUTILS_UYVY_X86 1
+#endif
+
+// Rows are padded to a full AVX-512 store
+#define AVUTILS_UYVY_ALIGN 64
+
+namespace AV::Utils {
+
+/**
+ * UYVY packs two pixels into four bytes: U0 Y0 V0 Y1.
+ *
+ * Every vector kernel first interleaves the chroma into U0 V0 U1 V1 ... and then
+ * interleaves that with luma, unpacklo/unpackhi(uv, y) yields U0 Y0 V0 Y1 U1 Y2 V1 Y3.
+ * Wider kernels work per 128 bit lane, so the halves are put back in order with a
+ * cross lane permute before the store. Whatever does not fill a vector goes through
+ * the scalar kernel.
+ */
+
+static void PackPlanarRowScalar(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width) {
+    int x = 0;
+    for (; x + 1 < width; x += 2) {
+        dst[0] = u[x / 2];
+        dst[1] = y[x];
+        dst[2] = v[x / 2];
+        dst[3] = y[x + 1];
+        dst += 4;
+    }
+
+    // Odd widths repeat the last luma sample
+    if (x < width) {
+        dst[0] = u[x / 2];
+        dst[1] = y[x];
+        dst[2] = v[x / 2];
+        dst[3] = y[x];
+    }
+}
+
+static void PackSemiPlanarRowScalar(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int width) {
+    int x = 0;
+    for (; x + 1 < width; x += 2) {
+        dst[0] = uv[x];
+        dst[1] = y[x];
+        dst[2] = uv[x + 1];
+        dst[3] = y[x + 1];
+        dst += 4;
+    }
+
+    if (x < width) {
+        dst[0] = uv[x];
+        dst[1] = y[x];
+        dst[2] = uv[x + 1];
+        dst[3] = y[x];
+    }
+}
+
+#ifdef AVUTILS_UYVY_X86
+
+__attribute__((target("sse4.1")))
+static void PackPlanarRowSSE41(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i luma = _mm_loadu_si128((const __m128i *)(y + x));
+        __m128i cb = _mm_loadl_epi64((const __m128i *)(u + x / 2));
+        __m128i cr = _mm_loadl_epi64((const __m128i *)(v + x / 2));
+
+        __m128i chroma = _mm_unpacklo_epi8(cb, cr);
+
+        _mm_storeu_si128((__m128i *)(dst + x * 2), _mm_unpacklo_epi8(chroma, luma));
+        _mm_storeu_si128((__m128i *)(dst + x * 2 + 16), _mm_unpackhi_epi8(chroma, luma));
+    }
+
+    PackPlanarRowScalar(y + x, u + x / 2, v + x / 2, dst + x * 2, width - x);
+}
+
+__attribute__((target("sse4.1")))
+static void PackSemiPlanarRowSSE41(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int width) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i luma = _mm_loadu_si128((const __m128i *)(y + x));
+        __m128i chroma = _mm_loadu_si128((const __m128i *)(uv + x));
+
+        _mm_storeu_si128((__m128i *)(dst + x * 2), _mm_unpacklo_epi8(chroma, luma));
+        _mm_storeu_si128((__m128i *)(dst + x * 2 + 16), _mm_unpackhi_epi8(chroma, luma));
+    }
+
+    PackSemiPlanarRowScalar(y + x, uv + x, dst + x * 2, width - x);
+}
+
+__attribute__((target("avx2")))
+static inline void StoreUYVYAVX2(__m256i chroma, __m256i luma, uint8_t *dst) {
+    // Per lane interleave, then put lane 0 of both halves first and lane 1 of both halves last
+    __m256i lo = _mm256_unpacklo_epi8(chroma, luma);
+    __m256i hi = _mm256_unpackhi_epi8(chroma, luma);
+
+    _mm256_storeu_si256((__m256i *)dst, _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256((__m256i *)(dst + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+__attribute__((target("avx2")))
+static void PackPlanarRowAVX2(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width) {
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i luma = _mm256_loadu_si256((const __m256i *)(y + x));
+        __m128i cb = _mm_loadu_si128((const __m128i *)(u + x / 2));
+        __m128i cr = _mm_loadu_si128((const __m128i *)(v + x / 2));
+
+        __m256i chroma = _mm256_set_m128i(_mm_unpackhi_epi8(cb, cr), _mm_unpacklo_epi8(cb, cr));
+
+        StoreUYVYAVX2(chroma, luma, dst + x * 2);
+    }
+
+    PackPlanarRowSSE41(y + x, u + x / 2, v + x / 2, dst + x * 2, width - x);
+}
+
+__attribute__((target("avx2")))
+static void PackSemiPlanarRowAVX2(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int width) {
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i luma = _mm256_loadu_si256((const __m256i *)(y + x));
+        __m256i chroma = _mm256_loadu_si256((const __m256i *)(uv + x));
+
+        StoreUYVYAVX2(chroma, luma, dst + x * 2);
+    }
+
+    PackSemiPlanarRowSSE41(y + x, uv + x, dst + x * 2, width - x);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static inline void StoreUYVYAVX512(__m512i chroma, __m512i luma, uint8_t *dst) {
+    // Qword indices, 8+ picks from the second operand
+    const __m512i first = _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0);
+    const __m512i second = _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4);
+
+    __m512i lo = _mm512_unpacklo_epi8(chroma, luma);
+    __m512i hi = _mm512_unpackhi_epi8(chroma, luma);
+
+    _mm512_storeu_si512((void *)dst, _mm512_permutex2var_epi64(lo, first, hi));
+    _mm512_storeu_si512((void *)(dst + 64), _mm512_permutex2var_epi64(lo, second, hi));
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void PackPlanarRowAVX512(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width) {
+    int x = 0;
+    for (; x + 64 <= width; x += 64) {
+        __m512i luma = _mm512_loadu_si512((const void *)(y + x));
+
+        // Widening puts every U in the low byte of a word, V goes in the high byte
+        __m512i cb = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(u + x / 2)));
+        __m512i cr = _mm512_cvtepu8_epi16(_mm256_loadu_si256((const __m256i *)(v + x / 2)));
+        __m512i chroma = _mm512_or_si512(cb, _mm512_slli_epi16(cr, 8));
+
+        StoreUYVYAVX512(chroma, luma, dst + x * 2);
+    }
+
+    PackPlanarRowAVX2(y + x, u + x / 2, v + x / 2, dst + x * 2, width - x);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static void PackSemiPlanarRowAVX512(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int width) {
+    int x = 0;
+    for (; x + 64 <= width; x += 64) {
+        __m512i luma = _mm512_loadu_si512((const void *)(y + x));
+        __m512i chroma = _mm512_loadu_si512((const void *)(uv + x));
+
+        StoreUYVYAVX512(chroma, luma, dst + x * 2);
+    }
+
+    PackSemiPlanarRowAVX2(y + x, uv + x, dst + x * 2, width - x);
+}
+
+#endif // AVUTILS_UYVY_X86
+
+bool UYVYConverter::IsSupported(AVPixelFormat pix_fmt) {
+    switch (pix_fmt) {
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUV422P:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool UYVYConverter::IsKernelSupported(UYVYKernel kernel) {
+    switch (kernel) {
+    case UYVYKernel::AUTO:
+    case UYVYKernel::SCALAR:
+        return true;
+#ifdef AVUTILS_UYVY_X86
+    case UYVYKernel::SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case UYVYKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+    case UYVYKernel::AVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief Create a new UYVYConverter object
+ *
+ * @param config The configuration for the UYVYConverter object
+ * @return UYVYConverterResult The UYVYConverter object
+ */
+UYVYConverterResult UYVYConverter::Create(const UYVYConverterConfig &config) {
+    FUNCTION_CALL_DEBUG();
+
+    try {
+        return {std::unique_ptr<UYVYConverter>(new UYVYConverter(config)), AvError::NOERROR};
+    } catch (const AvException &e) {
+        DEBUG("UYVYConverter error: %s", e.what());
+        return {nullptr, e};
+    }
+}
+
+UYVYConverter::UYVYConverter(const UYVYConverterConfig &config) : _config(config) {
+    FUNCTION_CALL_DEBUG();
+
+    AvError err = _Initialize();
+    if (err != AvError::NOERROR) {
+        throw AvException(err);
+    }
+}
+
+UYVYConverter::~UYVYConverter() {
+    FUNCTION_CALL_DEBUG();
+
+    // Frames still in flight keep the pool alive until they are freed
+    av_buffer_pool_uninit(&_pool);
+}
+
+AvError UYVYConverter::_Initialize() {
+    FUNCTION_CALL_DEBUG();
+
+    if (!IsSupported(_config.src_pix_fmt) || _config.width <= 0 || _config.height <= 0) {
+        return AvError::UNSUPPORTEDPIXFMT;
+    }
+
+    if (!IsKernelSupported(_config.kernel)) {
+        return AvError::UNSUPPORTEDCPU;
+    }
+
+    // Pick the widest kernel the CPU runs
+    _kernel = _config.kernel;
+    if (_kernel == UYVYKernel::AUTO) {
+        _kernel = UYVYKernel::SCALAR;
+        for (UYVYKernel kernel : {UYVYKernel::AVX512, UYVYKernel::AVX2, UYVYKernel::SSE41}) {
+            if (IsKernelSupported(kernel)) {
+                _kernel = kernel;
+                break;
+            }
+        }
+    }
+
+    switch (_kernel) {
+#ifdef AVUTILS_UYVY_X86
+    case UYVYKernel::AVX512:
+        _planar_row = PackPlanarRowAVX512;
+        _semi_planar_row = PackSemiPlanarRowAVX512;
+        break;
+    case UYVYKernel::AVX2:
+        _planar_row = PackPlanarRowAVX2;
+        _semi_planar_row = PackSemiPlanarRowAVX2;
+        break;
+    case UYVYKernel::SSE41:
+        _planar_row = PackPlanarRowSSE41;
+        _semi_planar_row = PackSemiPlanarRowSSE41;
+        break;
+#endif
+    default:
+        _planar_row = PackPlanarRowScalar;
+        _semi_planar_row = PackSemiPlanarRowScalar;
+        break;
+    }
+
+    _chroma_shift = _config.src_pix_fmt == AV_PIX_FMT_YUV422P ? 0 : 1;
+
+    // Two bytes per pixel, rounded up to a pixel pair and then to a full vector
+    int row_size = ((_config.width + 1) / 2) * 4;
+    _dst_stride = (row_size + AVUTILS_UYVY_ALIGN - 1) / AVUTILS_UYVY_ALIGN * AVUTILS_UYVY_ALIGN;
+
+    _band_rows = std::max(1, AVUTILS_BAND_BYTES / _dst_stride);
+
+    _pool = av_buffer_pool_init((size_t)_dst_stride * _config.height, nullptr);
+    if (_pool == nullptr) {
+        return AvError::AVMALLOC;
+    }
+
+    DEBUG("UYVYConverter kernel: %d", (int)_kernel);
+
+    return AvError::NOERROR;
+}
+
+void UYVYConverter::ConvertRows(const AVFrame *frame, uint8_t *dst, int dst_stride, int row_begin, int row_end) const {
+    for (int row = row_begin; row < row_end; row++) {
+        const uint8_t *y = frame->data[0] + (ptrdiff_t)row * frame->linesize[0];
+        const int chroma_row = row >> _chroma_shift;
+        uint8_t *dst_row = dst + (ptrdiff_t)row * dst_stride;
+
+        if (_config.src_pix_fmt == AV_PIX_FMT_NV12) {
+            _semi_planar_row(y, frame->data[1] + (ptrdiff_t)chroma_row * frame->linesize[1], dst_row, _config.width);
+        } else {
+            _planar_row(y,
+                        frame->data[1] + (ptrdiff_t)chroma_row * frame->linesize[1],
+                        frame->data[2] + (ptrdiff_t)chroma_row * frame->linesize[2],
+                        dst_row, _config.width);
+        }
+    }
+}
+
+UYVYConverterOutput UYVYConverter::Convert(const AVFrame *frame) {
+    FUNCTION_CALL_DEBUG();
+
+#ifdef _DEBUG
+    // Profile function
+    auto time_start = std::chrono::high_resolution_clock::now();
+#endif
+
+    if (frame->format != _config.src_pix_fmt || frame->width != _config.width || frame->height != _config.height) {
+        return {nullptr, AvError::UNSUPPORTEDPIXFMT};
+    }
+
+    AVFrame *dst_frame = av_frame_alloc();
+    if (dst_frame == nullptr) {
+        return {nullptr, AvError::FRAMEALLOC};
+    }
+
+    dst_frame->buf[0] = av_buffer_pool_get(_pool);
+    if (dst_frame->buf[0] == nullptr) {
+        av_frame_free(&dst_frame);
+        return {nullptr, AvError::AVMALLOC};
+    }
+
+    dst_frame->data[0] = dst_frame->buf[0]->data;
+    dst_frame->linesize[0] = _dst_stride;
+    dst_frame->width = _config.width;
+    dst_frame->height = _config.height;
+    dst_frame->format = AV_PIX_FMT_UYVY422;
+
+    // Timestamps and the rest of the metadata carry over
+    int ret = av_frame_copy_props(dst_frame, frame);
+    if (ret < 0) {
+        PRINT_FFMPEG_ERR(ret);
+        av_frame_free(&dst_frame);
+        return {nullptr, AvError::FRAMECOPY};
+    }
+
+    if (_config.thread_pool != nullptr && _config.thread_pool->GetThreadCount() > 1) {
+        // Bands are independent, so the result is identical to a single pass
+        size_t bands = (_config.height + _band_rows - 1) / _band_rows;
+        _config.thread_pool->ParallelFor(bands, [this, frame, dst_frame](size_t band) {
+            int row_begin = (int)band * _band_rows;
+            ConvertRows(frame, dst_frame->data[0], _dst_stride, row_begin, std::min(row_begin + _band_rows, _config.height));
+        });
+    } else {
+        ConvertRows(frame, dst_frame->data[0], _dst_stride, 0, _config.height);
+    }
+
+#ifdef _DEBUG
+    // Profile function
+    auto time_end = std::chrono::high_resolution_clock::now();
+    DEBUG("UYVY convert time (seconds): %f", std::chrono::duration<double>(time_end - time_start).count());
+#endif
+
+    return {dst_frame, AvError::NOERROR};
+}
+
+} // namespace AV::Utils
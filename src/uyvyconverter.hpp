@@ -0,0 +1,121 @@
+/**
+ * @file uyvyconverter.hpp
+ * @brief Vectorized packing of decoded video into NDI's native UYVY
+ * @version 1.0
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#pragma once
+
+#include "averror.hpp"
+#include "threadpool.hpp"
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+}
+
+#include <cstdint>
+#include <memory>
+
+namespace AV::Utils {
+
+// Forward declarations and type definitions
+class UYVYConverter;
+using UYVYConverterResult = std::pair<std::unique_ptr<UYVYConverter>, const AvException>;
+using UYVYConverterOutput = std::pair<AVFrame *, const AvException>;
+
+/**
+ * @brief Instruction set used by the row kernels
+ */
+enum class UYVYKernel {
+    AUTO,
+    SCALAR,
+    SSE41,
+    AVX2,
+    AVX512
+};
+
+/**
+ * @brief The UYVYConverterConfig struct represents the configuration for the UYVYConverter object.
+ */
+typedef struct UYVYConverterConfig {
+    int width{}, height{};
+    AVPixelFormat src_pix_fmt{};
+    UYVYKernel kernel = UYVYKernel::AUTO;
+    std::shared_ptr<ThreadPool> thread_pool; // Optional, rows are split into bands across it
+} UYVYConverterConfig;
+
+/**
+ * @brief Packs limited range NV12, YUV420P and YUV422P frames into UYVY.
+ *
+ * This is a pure reshuffle of the 8 bit samples, 4:2:0 chroma rows are shared by
+ * two luma rows exactly like swscale's unscaled path. Nothing is scaled, so full range
+ * input (the YUVJ formats or AVCOL_RANGE_JPEG frames) has to go through swscale instead. The row kernel is picked once
+ * from the best instruction set the CPU supports, output frames come from a buffer pool.
+ */
+class UYVYConverter {
+private:
+    UYVYConverter(const UYVYConverterConfig &config);
+    AvError _Initialize();
+
+public:
+    ~UYVYConverter();
+
+    // Factory
+    static UYVYConverterResult Create(const UYVYConverterConfig &config);
+
+    /**
+     * @brief Check if a pixel format can be packed by the converter
+     */
+    static bool IsSupported(AVPixelFormat pix_fmt);
+
+    /**
+     * @brief Check if the CPU can run a kernel
+     */
+    static bool IsKernelSupported(UYVYKernel kernel);
+
+    /**
+     * @brief Convert a frame into a new UYVY frame
+     *
+     * @param frame The source frame, it must match the configured size and format
+     * @return UYVYConverterOutput The UYVY frame, owned by the caller
+     */
+    UYVYConverterOutput Convert(const AVFrame *frame);
+
+    /**
+     * @brief Pack a band of rows into a UYVY image
+     *
+     * @param frame The source frame
+     * @param dst The first byte of the destination image
+     * @param dst_stride The destination stride in bytes
+     * @param row_begin First row to pack
+     * @param row_end One past the last row to pack
+     */
+    void ConvertRows(const AVFrame *frame, uint8_t *dst, int dst_stride, int row_begin, int row_end) const;
+
+    UYVYKernel GetKernel() const { return _kernel; }
+
+private:
+    using PlanarRowFn = void (*)(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width);
+    using SemiPlanarRowFn = void (*)(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int width);
+
+    UYVYConverterConfig _config;
+    UYVYKernel _kernel = UYVYKernel::SCALAR;
+
+    PlanarRowFn _planar_row = nullptr;
+    SemiPlanarRowFn _semi_planar_row = nullptr;
+
+    // 4:2:0 sources share each chroma row between two luma rows
+    int _chroma_shift = 0;
+
+    AVBufferPool *_pool = nullptr;
+    int _dst_stride = 0;
+
+    // Rows handed to each pool thread at a time
+    int _band_rows = 0;
+};
+
+} // namespace AV::Utils
@@ -9,6 +9,10 @@
 #include "vaapidecoder.hpp"
 #include "macro.hpp"
 
+extern "C" {
+#include <libavutil/hwcontext.h>
+}
+
 #include <chrono>
 
 namespace AV::Utils {
@@ -44,6 +48,15 @@ AvException VAAPIDecoder::FillVAAPIDecoder(AVPacket *packet) {
     return AvException(AvError::NOERROR);
 }
 
+/**
+ * @brief Drop everything the VAAPIDecoder holds and leave draining mode
+ */
+void VAAPIDecoder::Flush() {
+    FUNCTION_CALL_DEBUG();
+
+    avcodec_flush_buffers(m_codec);
+}
+
 /**
  * @brief Decode a packet
  *
@@ -57,11 +70,10 @@ VAAPIDecoderOutput VAAPIDecoder::Decode() {
 #endif
 
     av_frame_unref(m_last_frame);
-
-    AVFrame *tmp_frame = av_frame_alloc();
+    av_frame_unref(m_hw_frame);
 
     // Recieve frame from decoder
-    int ret = avcodec_receive_frame(m_codec, tmp_frame);
+    int ret = avcodec_receive_frame(m_codec, m_hw_frame);
     if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
         DEBUG("VAAPIDecoder exhausted");
         return {nullptr, AvException(AvError::DECODEREXHAUSTED)};
@@ -70,19 +82,36 @@ VAAPIDecoderOutput VAAPIDecoder::Decode() {
         return {nullptr, AvException(AvError::RECIEVEFRAME)};
     }
 
-    // Print out tmp frame info
-    DEBUG("Temp Frame: %dx%d, format: %s, pts: %ld", tmp_frame->width, tmp_frame->height, av_get_pix_fmt_name((AVPixelFormat)tmp_frame->format), tmp_frame->pts);
+    // Print out hw frame info
+    DEBUG("HW Frame: %dx%d, format: %s, pts: %ld", m_hw_frame->width, m_hw_frame->height, av_get_pix_fmt_name((AVPixelFormat)m_hw_frame->format), m_hw_frame->pts);
+
+    // Download into a pooled buffer at the display size. NV12 comes out contiguous, so on the
+    // default passthrough pipeline NV12Packer sends it to NDI without packing the planes
+    if (m_hw_frame->hw_frames_ctx) {
+        m_last_frame->format = ((AVHWFramesContext *)m_hw_frame->hw_frames_ctx->data)->sw_format;
+        m_last_frame->width = m_hw_frame->width;
+        m_last_frame->height = m_hw_frame->height;
+
+        ret = m_buffer_pool.GetBuffer(m_last_frame, m_last_frame->width, m_last_frame->height);
+        if (ret < 0) {
+            PRINT_FFMPEG_ERR(ret);
+            return {nullptr, AvException(AvError::FRAMEALLOC)};
+        }
+    }
 
     // Load from off gpu if needed
-    ret = av_hwframe_transfer_data(m_last_frame, tmp_frame, 0);
+    ret = av_hwframe_transfer_data(m_last_frame, m_hw_frame, 0);
     if (ret < 0) {
         PRINT_FFMPEG_ERR(ret);
         return {nullptr, AvException(AvError::HWFRAME_TRANSFER)};
     }
 
-    m_last_frame->pts = tmp_frame->pts;
-
-    av_frame_free(&tmp_frame);
+    // pts, timing and colour properties travel with the frame
+    ret = av_frame_copy_props(m_last_frame, m_hw_frame);
+    if (ret < 0) {
+        PRINT_FFMPEG_ERR(ret);
+        return {nullptr, AvException(AvError::FRAMEALLOC)};
+    }
 
 #ifdef _DEBUG
     // Profile function
@@ -152,6 +181,10 @@ VAAPIDecoder::~VAAPIDecoder() {
         DEBUG("av_frame_free called");
     }
 
+    if (m_hw_frame) {
+        av_frame_free(&m_hw_frame);
+    }
+
     // Close and free the decoder context
     if (m_codec) {
         avcodec_close(m_codec);
@@ -219,6 +252,12 @@ AvError VAAPIDecoder::m_Initialize() {
         return AvError::FRAMEALLOC;
     }
 
+    m_hw_frame = av_frame_alloc();
+    if (!m_hw_frame) {
+        DEBUG("av_frame_alloc failed");
+        return AvError::FRAMEALLOC;
+    }
+
     return AvError::NOERROR;
 }
 
@@ -11,6 +11,7 @@
 // Local dependencies
 #include "averror.hpp"
 #include "demuxer.hpp"
+#include "framepool.hpp"
 
 // 3rd party dependencies
 extern "C" {
@@ -68,6 +69,12 @@ public:
      */
     VAAPIDecoderOutput Decode();
 
+    /**
+     * @brief Drop everything the VAAPIDecoder holds and leave draining mode,
+     * call after a seek or once it has been drained with a null packet
+     */
+    void Flush();
+
     // Getters
     /**
      * @brief Get the frame rate of the VAAPIDecoder
@@ -90,6 +97,12 @@ private:
     // This is the last frame that was decoded
     AVFrame *m_last_frame = nullptr;
 
+    // The frame still on the GPU
+    AVFrame *m_hw_frame = nullptr;
+
+    // Frames are downloaded from the GPU into these buffers
+    FrameBufferPool m_buffer_pool;
+
     // Reference to the hardware device context
     AVBufferRef *m_hw_device_ctx = nullptr;
 
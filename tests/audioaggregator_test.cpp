@@ -0,0 +1,175 @@
+/**
+ * @file audioaggregator_test.cpp
+ * @brief This file includes tests for the AudioAggregator class.
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include <gtest/gtest.h>
+
+#include "audioaggregator.hpp"
+
+#include <vector>
+
+static AV::Utils::AudioAggregatorConfig MakeConfig(AVRational frame_rate) {
+    AV::Utils::AudioAggregatorConfig config{};
+    config.frame_rate = frame_rate;
+    config.sample_rate = 48000;
+    config.sample_fmt = AV_SAMPLE_FMT_FLTP;
+    config.ch_layout = AV_CHANNEL_LAYOUT_STEREO;
+    return config;
+}
+
+// Feed 1024 sample frames, sample i of the stream holds the value i
+static void AddFrames(AV::Utils::AudioAggregator &aggregator, int count, int64_t &next_sample) {
+    std::vector<float> left(1024), right(1024);
+
+    for (int f = 0; f < count; f++) {
+        for (int i = 0; i < 1024; i++) {
+            left[i] = right[i] = (float)(next_sample + i);
+        }
+
+        AVFrame frame{};
+        frame.nb_samples = 1024;
+        frame.pts = next_sample;
+        frame.time_base = {1, 48000};
+        frame.data[0] = (uint8_t *)left.data();
+        frame.data[1] = (uint8_t *)right.data();
+        frame.extended_data = frame.data;
+
+        ASSERT_EQ(aggregator.AddFrame(&frame).code(), 0);
+        next_sample += 1024;
+    }
+}
+
+TEST(AudioAggregatorTest, NTSCCadence) {
+    auto [aggregator, aggregator_err] = AV::Utils::AudioAggregator::Create(MakeConfig({30000, 1001}));
+    ASSERT_EQ(aggregator_err.code(), 0);
+
+    // Five video frames at 29.97 carry exactly 8008 samples at 48 kHz
+    int total = 0;
+    for (int k = 0; k < 5; k++) {
+        int samples = aggregator->GetChunkSamples(k);
+        EXPECT_TRUE(samples == 1601 || samples == 1602);
+        total += samples;
+    }
+
+    EXPECT_EQ(total, 8008);
+}
+
+TEST(AudioAggregatorTest, ChunksAreContinuous) {
+    auto [aggregator, aggregator_err] = AV::Utils::AudioAggregator::Create(MakeConfig({30000, 1001}));
+    ASSERT_EQ(aggregator_err.code(), 0);
+
+    int64_t added = 0;
+    AddFrames(*aggregator, 20, added);
+
+    int64_t expected_pts = 0;
+    int64_t chunk_index = 0;
+    while (true) {
+        auto [chunk, chunk_err] = aggregator->GetChunk();
+        if (chunk_err.code()) {
+            EXPECT_EQ(chunk_err.code(), (int)AV::Utils::AvError::AGGREGATOREXHAUSTED);
+            break;
+        }
+
+        EXPECT_EQ(chunk->pts, expected_pts);
+        EXPECT_EQ(chunk->nb_samples, aggregator->GetChunkSamples(chunk_index));
+
+        // No sample is lost or repeated across chunk boundaries
+        const float *left = (const float *)chunk->data[0];
+        EXPECT_EQ(left[0], (float)expected_pts);
+        EXPECT_EQ(left[chunk->nb_samples - 1], (float)(expected_pts + chunk->nb_samples - 1));
+
+        expected_pts += chunk->nb_samples;
+        chunk_index++;
+    }
+
+    // Flushing hands out the rest
+    auto [tail, tail_err] = aggregator->GetChunk(true);
+    ASSERT_EQ(tail_err.code(), 0);
+    EXPECT_EQ(tail->pts, expected_pts);
+    EXPECT_EQ(expected_pts + tail->nb_samples, added);
+}
+
+TEST(AudioAggregatorTest, ResetReanchors) {
+    auto [aggregator, aggregator_err] = AV::Utils::AudioAggregator::Create(MakeConfig({25, 1}));
+    ASSERT_EQ(aggregator_err.code(), 0);
+
+    int64_t added = 0;
+    AddFrames(*aggregator, 3, added);
+
+    auto [first, first_err] = aggregator->GetChunk();
+    ASSERT_EQ(first_err.code(), 0);
+    EXPECT_EQ(first->pts, 0);
+
+    // A loop seam, the next pass starts a minute later
+    aggregator->Reset();
+    added = 48000 * 60;
+    AddFrames(*aggregator, 2, added);
+
+    auto [second, second_err] = aggregator->GetChunk();
+    ASSERT_EQ(second_err.code(), 0);
+    EXPECT_EQ(second->pts, 48000 * 60);
+    EXPECT_EQ(second->nb_samples, aggregator->GetChunkSamples(0));
+    EXPECT_EQ(((const float *)second->data[0])[0], (float)(48000 * 60));
+}
+
+TEST(AudioAggregatorTest, LateAudioFollowsFrameGrid) {
+    auto config = MakeConfig({30000, 1001});
+    config.start_us = 0;
+
+    auto [aggregator, aggregator_err] = AV::Utils::AudioAggregator::Create(config);
+    ASSERT_EQ(aggregator_err.code(), 0);
+
+    // Audio starts 500 samples into video frame 0, which ends at sample 1601
+    int64_t added = 500;
+    AddFrames(*aggregator, 4, added);
+
+    auto [first, first_err] = aggregator->GetChunk();
+    ASSERT_EQ(first_err.code(), 0);
+    EXPECT_EQ(first->pts, 500);
+    EXPECT_EQ(first->nb_samples, 1101);
+
+    auto [second, second_err] = aggregator->GetChunk();
+    ASSERT_EQ(second_err.code(), 0);
+    EXPECT_EQ(second->pts, 1601);
+    EXPECT_EQ(second->nb_samples, aggregator->GetChunkSamples(1));
+}
+
+TEST(AudioAggregatorTest, EarlyAudioEndsOnFirstVideoFrame) {
+    auto config = MakeConfig({25, 1});
+    config.start_us = 20000;
+
+    auto [aggregator, aggregator_err] = AV::Utils::AudioAggregator::Create(config);
+    ASSERT_EQ(aggregator_err.code(), 0);
+
+    // Video frame 0 is at sample 960, the audio before it is a chunk of its own
+    int64_t added = 0;
+    AddFrames(*aggregator, 4, added);
+
+    auto [first, first_err] = aggregator->GetChunk();
+    ASSERT_EQ(first_err.code(), 0);
+    EXPECT_EQ(first->pts, 0);
+    EXPECT_EQ(first->nb_samples, 960);
+
+    auto [second, second_err] = aggregator->GetChunk();
+    ASSERT_EQ(second_err.code(), 0);
+    EXPECT_EQ(second->pts, 960);
+    EXPECT_EQ(second->nb_samples, 1920);
+
+    // A looped pass keeps the audio the same distance ahead of its first frame
+    aggregator->Reset();
+    added = 48000 * 60;
+    AddFrames(*aggregator, 2, added);
+
+    auto [looped, looped_err] = aggregator->GetChunk();
+    ASSERT_EQ(looped_err.code(), 0);
+    EXPECT_EQ(looped->pts, 48000 * 60);
+    EXPECT_EQ(looped->nb_samples, 960);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -11,6 +11,13 @@
 #include "decoder.hpp"
 #include "demuxer.hpp"
 
+extern "C" {
+#include <libavutil/mem.h>
+#include <libavutil/samplefmt.h>
+}
+
+#include <vector>
+
 TEST(AudioResamplerTest, ResampleMultipleFrames) {
     auto [demuxer, demuxer_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4");
     auto streams = demuxer->GetStreamPointers();
@@ -57,6 +64,104 @@ TEST(AudioResamplerTest, ResampleMultipleFrames) {
     }
 }
 
+TEST(AudioResamplerTest, HeldOutputIsNotOverwritten) {
+    auto [demuxer, demuxer_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4");
+    auto streams = demuxer->GetStreamPointers();
+
+    AVCodecParameters *codecpar = streams[1]->codecpar;
+
+    auto [decoder, decoder_err] = AV::Utils::Decoder::Create(codecpar);
+
+    AV::Utils::AudioResamplerConfig config;
+    config.srcsamplerate = codecpar->sample_rate;
+    config.dstsamplerate = codecpar->sample_rate;
+    config.srcchannellayout = codecpar->ch_layout;
+    config.dstchannellayout = AV_CHANNEL_LAYOUT_STEREO;
+    config.srcsampleformat = (AVSampleFormat)codecpar->format;
+    config.dstsampleformat = AV_SAMPLE_FMT_S16;
+
+    auto [resampler, resampler_err] = AV::Utils::AudioResampler::Create(config);
+    ASSERT_EQ(resampler_err.code(), 0);
+
+    // Keep every output alive, the pool must hand out a fresh buffer each time
+    std::vector<AVFrame *> held;
+    while (held.size() < 8) {
+        auto [packet, packet_err] = demuxer->ReadFrame();
+        ASSERT_EQ(packet_err.code(), 0);
+        if (packet->stream_index != 1) {
+            continue;
+        }
+
+        EXPECT_EQ(decoder->FillDecoder(packet).code(), 0);
+
+        while (true) {
+            auto [frame, frame_err] = decoder->Decode();
+            if (frame_err.code()) {
+                break;
+            }
+
+            auto [resampled_frame, resampled_frame_err] = resampler->Resample(frame);
+            ASSERT_EQ(resampled_frame_err.code(), 0);
+
+            for (AVFrame *previous : held) {
+                EXPECT_NE(previous->data[0], resampled_frame->data[0]);
+            }
+
+            held.push_back(av_frame_clone(resampled_frame));
+        }
+    }
+
+    for (AVFrame *frame : held) {
+        av_frame_free(&frame);
+    }
+}
+
+// Silent stereo frame whose layout is a custom map owned by the frame
+static AVFrame *MakeCustomLayoutFrame(int nb_samples) {
+    AVFrame *frame = av_frame_alloc();
+    frame->format = AV_SAMPLE_FMT_FLTP;
+    frame->sample_rate = 48000;
+    frame->nb_samples = nb_samples;
+    frame->ch_layout.order = AV_CHANNEL_ORDER_CUSTOM;
+    frame->ch_layout.nb_channels = 2;
+    frame->ch_layout.u.map = (AVChannelCustom *)av_calloc(2, sizeof(AVChannelCustom));
+    frame->ch_layout.u.map[0].id = AV_CHAN_FRONT_LEFT;
+    frame->ch_layout.u.map[1].id = AV_CHAN_FRONT_RIGHT;
+    av_frame_get_buffer(frame, 0);
+    av_samples_set_silence(frame->extended_data, 0, nb_samples, 2, AV_SAMPLE_FMT_FLTP);
+
+    return frame;
+}
+
+TEST(AudioResamplerTest, CustomLayoutOutlivesSourceFrames) {
+    AVFrame *first = MakeCustomLayoutFrame(1024);
+
+    AV::Utils::AudioResamplerConfig config;
+    config.srcsamplerate = first->sample_rate;
+    config.dstsamplerate = 48000;
+    config.srcchannellayout = first->ch_layout;
+    config.dstchannellayout = AV_CHANNEL_LAYOUT_STEREO;
+    config.srcsampleformat = (AVSampleFormat)first->format;
+    config.dstsampleformat = AV_SAMPLE_FMT_S16;
+
+    auto [resampler, resampler_err] = AV::Utils::AudioResampler::Create(config);
+    ASSERT_EQ(resampler_err.code(), 0);
+
+    auto [first_output, first_output_err] = resampler->Resample(first);
+    EXPECT_EQ(first_output_err.code(), 0);
+
+    // The map of every frame is gone before the next one is compared against it
+    av_frame_free(&first);
+    for (int i = 0; i < 3; i++) {
+        AVFrame *frame = MakeCustomLayoutFrame(1024);
+
+        auto [output, output_err] = resampler->Resample(frame);
+        EXPECT_EQ(output_err.code(), 0);
+
+        av_frame_free(&frame);
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
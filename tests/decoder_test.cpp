@@ -19,6 +19,23 @@ TEST(DecoderTest, CreateDecoderSimple) {
     EXPECT_EQ(decoder_err.code(), 0);
 }
 
+TEST(DecoderTest, CreateDecoderThreaded) {
+    auto [demuxer, demuxer_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4");
+    auto streams = demuxer->GetStreamPointers();
+
+    AVCodecParameters *codecpar = streams[0]->codecpar;
+
+    for (auto type : {AV::Utils::DecoderThreadType::FRAME, AV::Utils::DecoderThreadType::SLICE,
+                      AV::Utils::DecoderThreadType::BOTH, AV::Utils::DecoderThreadType::NONE}) {
+        AV::Utils::DecoderConfig config{};
+        config.thread_type = type;
+        config.channels = 4;
+
+        auto [decoder, decoder_err] = AV::Utils::Decoder::Create(codecpar, config);
+        EXPECT_EQ(decoder_err.code(), 0);
+    }
+}
+
 TEST(DecoderTest, DecodeSinglePacket) {
     auto [demuxer, demuxer_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4");
     auto streams = demuxer->GetStreamPointers();
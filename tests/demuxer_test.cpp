@@ -8,6 +8,10 @@
 #include <gtest/gtest.h>
 
 #include "demuxer.hpp"
+#include "streaminfocache.hpp"
+
+#include <cstring>
+#include <filesystem>
 
 TEST(DemuxerTest, CreateDemuxerAuto) {
     auto [demuxer, demuxer_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4");
@@ -36,6 +40,87 @@ TEST(DemuxerTest, GetStreamPointers) {
     EXPECT_EQ(streams.size(), 2);
 }
 
+TEST(DemuxerTest, MemoryMappedMatchesFile) {
+    AV::Utils::DemuxerConfig config;
+    config.memory_map = true;
+
+    auto [file_demuxer, file_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4");
+    auto [mapped_demuxer, mapped_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4", config);
+    ASSERT_EQ(file_err.code(), 0);
+    ASSERT_EQ(mapped_err.code(), 0);
+
+    for (int i = 0; i < 200; i++) {
+        auto [file_packet, file_packet_err] = file_demuxer->ReadFrame();
+        auto [mapped_packet, mapped_packet_err] = mapped_demuxer->ReadFrame();
+        ASSERT_EQ(file_packet_err.code(), mapped_packet_err.code());
+        if (file_packet_err.code()) {
+            break;
+        }
+
+        EXPECT_EQ(file_packet->stream_index, mapped_packet->stream_index);
+        EXPECT_EQ(file_packet->pts, mapped_packet->pts);
+        ASSERT_EQ(file_packet->size, mapped_packet->size);
+        EXPECT_EQ(memcmp(file_packet->data, mapped_packet->data, file_packet->size), 0);
+    }
+}
+
+TEST(DemuxerTest, MemoryMappedSeek) {
+    AV::Utils::DemuxerConfig config;
+    config.memory_map = true;
+
+    auto [demuxer, demuxer_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4", config);
+    ASSERT_EQ(demuxer_err.code(), 0);
+
+    for (int i = 0; i < 50; i++) {
+        demuxer->ReadFrame();
+    }
+
+    EXPECT_EQ(demuxer->Seek(0).code(), 0);
+
+    auto [packet, packet_err] = demuxer->ReadFrame();
+    EXPECT_EQ(packet_err.code(), 0);
+}
+
+TEST(DemuxerTest, StreamInfoCacheMatchesProbe) {
+    std::filesystem::path cache_dir = std::filesystem::temp_directory_path() / "demuxer_test_probe_cache";
+    std::filesystem::remove_all(cache_dir);
+    std::filesystem::create_directories(cache_dir);
+
+    AV::Utils::DemuxerConfig config;
+    config.stream_info_cache_dir = cache_dir.string();
+
+    // The first open probes and writes the sidecar, the second one reads it
+    auto [probed_demuxer, probed_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4", config);
+    ASSERT_EQ(probed_err.code(), 0);
+    ASSERT_TRUE(std::filesystem::exists(AV::Utils::StreamInfoCachePath(cache_dir.string(), "testcontent/rickroll.mp4")));
+
+    auto [cached_demuxer, cached_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4", config);
+    ASSERT_EQ(cached_err.code(), 0);
+
+    auto probed_streams = probed_demuxer->GetStreamPointers();
+    auto cached_streams = cached_demuxer->GetStreamPointers();
+    ASSERT_EQ(probed_streams.size(), cached_streams.size());
+
+    for (size_t i = 0; i < probed_streams.size(); i++) {
+        const AVCodecParameters *probed = probed_streams[i]->codecpar;
+        const AVCodecParameters *cached = cached_streams[i]->codecpar;
+        EXPECT_EQ(probed->codec_id, cached->codec_id);
+        EXPECT_EQ(probed->format, cached->format);
+        EXPECT_EQ(probed->width, cached->width);
+        EXPECT_EQ(probed->height, cached->height);
+        EXPECT_EQ(probed->sample_rate, cached->sample_rate);
+        EXPECT_EQ(probed->ch_layout.nb_channels, cached->ch_layout.nb_channels);
+        EXPECT_EQ(probed->extradata_size, cached->extradata_size);
+        EXPECT_EQ(probed_streams[i]->avg_frame_rate.num, cached_streams[i]->avg_frame_rate.num);
+        EXPECT_EQ(probed_streams[i]->avg_frame_rate.den, cached_streams[i]->avg_frame_rate.den);
+    }
+
+    auto [packet, packet_err] = cached_demuxer->ReadFrame();
+    EXPECT_EQ(packet_err.code(), 0);
+
+    std::filesystem::remove_all(cache_dir);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
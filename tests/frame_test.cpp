@@ -0,0 +1,178 @@
+/**
+ * @file frame_test.cpp
+ * @brief This file includes tests for the AVFrame helpers.
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include <gtest/gtest.h>
+
+#include "frame.hpp"
+
+#include <cstring>
+#include <vector>
+
+TEST(FrameTest, ContiguousNV12IsPassedThrough) {
+    const int width = 64, height = 32;
+    std::vector<uint8_t> buffer(width * height * 3 / 2);
+
+    AVFrame frame{};
+    frame.width = width;
+    frame.height = height;
+    frame.linesize[0] = width;
+    frame.linesize[1] = width;
+    frame.data[0] = buffer.data();
+    frame.data[1] = buffer.data() + width * height;
+
+    AV::Utils::NV12Packer packer;
+    AVBufferRef *packed_buffer = nullptr;
+
+    EXPECT_EQ(packer.Pack(&frame, &packed_buffer), buffer.data());
+    EXPECT_EQ(packed_buffer, nullptr);
+
+    auto stats = packer.GetStats();
+    EXPECT_EQ(stats.zero_copy_frames, 1u);
+    EXPECT_EQ(stats.packed_frames, 0u);
+}
+
+TEST(FrameTest, SplitNV12IsPacked) {
+    const int width = 64, height = 32, uv_stride = 96;
+    std::vector<uint8_t> y_plane(width * height);
+    std::vector<uint8_t> uv_plane(uv_stride * height / 2);
+
+    for (size_t i = 0; i < y_plane.size(); i++) y_plane[i] = (uint8_t)i;
+    for (size_t i = 0; i < uv_plane.size(); i++) uv_plane[i] = (uint8_t)(i * 7);
+
+    AVFrame frame{};
+    frame.width = width;
+    frame.height = height;
+    frame.linesize[0] = width;
+    frame.linesize[1] = uv_stride;
+    frame.data[0] = y_plane.data();
+    frame.data[1] = uv_plane.data();
+
+    EXPECT_FALSE(AV::Utils::IsContiguousNV12(&frame));
+
+    AV::Utils::NV12Packer packer;
+    AVBufferRef *packed_buffer = nullptr;
+
+    uint8_t *packed = packer.Pack(&frame, &packed_buffer);
+    ASSERT_NE(packed, nullptr);
+    ASSERT_NE(packed_buffer, nullptr);
+
+    // Y is copied as is, UV is restrided to the Y stride
+    EXPECT_EQ(memcmp(packed, y_plane.data(), y_plane.size()), 0);
+    for (int row = 0; row < height / 2; row++) {
+        EXPECT_EQ(memcmp(packed + width * height + row * width, uv_plane.data() + row * uv_stride, width), 0);
+    }
+
+    av_buffer_unref(&packed_buffer);
+
+    auto stats = packer.GetStats();
+    EXPECT_EQ(stats.zero_copy_frames, 0u);
+    EXPECT_EQ(stats.packed_frames, 1u);
+}
+
+TEST(FrameTest, PlanarAudioIsPassedThrough) {
+    const int samples = 1024, channels = 2;
+    std::vector<float> buffer(samples * channels);
+
+    AVFrame frame{};
+    frame.nb_samples = samples;
+    frame.ch_layout.nb_channels = channels;
+    frame.data[0] = (uint8_t *)buffer.data();
+    frame.data[1] = (uint8_t *)(buffer.data() + samples);
+    frame.extended_data = frame.data;
+
+    std::vector<uint8_t> scratch;
+    int channel_stride = 0;
+
+    EXPECT_EQ(AV::Utils::PackPlanarAudio(&frame, scratch, channel_stride), (uint8_t *)buffer.data());
+    EXPECT_EQ(channel_stride, samples * (int)sizeof(float));
+    EXPECT_TRUE(scratch.empty());
+}
+
+TEST(FrameTest, ScatteredPlanarAudioIsPacked) {
+    const int samples = 960, channels = 3;
+
+    // Planes spaced unevenly within one buffer
+    const int offsets[channels] = {0, samples + 16, samples * 2 + 64};
+    std::vector<float> buffer(samples * 3 + 64);
+
+    AVFrame frame{};
+    frame.nb_samples = samples;
+    frame.ch_layout.nb_channels = channels;
+    for (int c = 0; c < channels; c++) {
+        for (int i = 0; i < samples; i++) {
+            buffer[offsets[c] + i] = c + i / (float)samples;
+        }
+
+        frame.data[c] = (uint8_t *)(buffer.data() + offsets[c]);
+    }
+    frame.extended_data = frame.data;
+
+    std::vector<uint8_t> scratch;
+    int channel_stride = 0;
+
+    const float *packed = (const float *)AV::Utils::PackPlanarAudio(&frame, scratch, channel_stride);
+    ASSERT_EQ(channel_stride, samples * (int)sizeof(float));
+
+    for (int c = 0; c < channels; c++) {
+        EXPECT_EQ(memcmp(packed + samples * c, buffer.data() + offsets[c], samples * sizeof(float)), 0);
+    }
+}
+
+TEST(FrameTest, ReversedPlanarAudioIsPacked) {
+    const int samples = 960, channels = 2;
+
+    // Evenly spaced but in reverse order, the distance between planes is negative
+    std::vector<float> buffer(samples * channels);
+
+    AVFrame frame{};
+    frame.nb_samples = samples;
+    frame.ch_layout.nb_channels = channels;
+    for (int c = 0; c < channels; c++) {
+        float *plane = buffer.data() + samples * (channels - 1 - c);
+        for (int i = 0; i < samples; i++) {
+            plane[i] = c + i / (float)samples;
+        }
+
+        frame.data[c] = (uint8_t *)plane;
+    }
+    frame.extended_data = frame.data;
+
+    std::vector<uint8_t> scratch;
+    int channel_stride = 0;
+
+    const float *packed = (const float *)AV::Utils::PackPlanarAudio(&frame, scratch, channel_stride);
+    ASSERT_EQ(packed, (const float *)scratch.data());
+    ASSERT_EQ(channel_stride, samples * (int)sizeof(float));
+
+    for (int c = 0; c < channels; c++) {
+        EXPECT_EQ(memcmp(packed + samples * c, frame.data[c], samples * sizeof(float)), 0);
+    }
+}
+
+TEST(FrameTest, TimecodesFollowPts) {
+    AV::Utils::NDITimecode timecode;
+
+    AVFrame video{};
+    video.pts = 3003;
+    video.time_base = {1, 30000};
+
+    AVFrame audio{};
+    audio.pts = 48000;
+    audio.time_base = {1, 48000};
+
+    // 0.1001 s of video, then audio one second in, both against the same epoch
+    int64_t video_timecode = timecode.Timecode(&video);
+    int64_t audio_timecode = timecode.Timecode(&audio);
+    EXPECT_EQ(audio_timecode - video_timecode, 10000000 - 1001000);
+
+    video.pts += 1001;
+    EXPECT_EQ(timecode.Timecode(&video) - video_timecode, 333667);
+
+    AVFrame untimed{};
+    untimed.pts = AV_NOPTS_VALUE;
+    EXPECT_EQ(timecode.Timecode(&untimed), AV::Utils::NDITimecode::kSynthesize);
+}
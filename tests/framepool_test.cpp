@@ -0,0 +1,92 @@
+/**
+ * @file framepool_test.cpp
+ * @brief This file includes tests for the FrameBufferPool class.
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include <gtest/gtest.h>
+
+#include "decoder.hpp"
+#include "frame.hpp"
+#include "framepool.hpp"
+
+#include <cstdint>
+
+TEST(FrameBufferPoolTest, NV12IsContiguousAndAligned) {
+    AV::Utils::FrameBufferPool pool;
+
+    AVFrame *frame = av_frame_alloc();
+    frame->format = AV_PIX_FMT_NV12;
+    frame->width = 1918;
+    frame->height = 1080;
+
+    ASSERT_EQ(pool.GetBuffer(frame, frame->width, frame->height), 0);
+
+    EXPECT_EQ(frame->linesize[0] % AVUTILS_FRAME_ALIGN, 0);
+    EXPECT_EQ((uintptr_t)frame->data[0] % AVUTILS_FRAME_ALIGN, 0u);
+    EXPECT_TRUE(AV::Utils::IsContiguousNV12(frame));
+
+    av_frame_free(&frame);
+}
+
+TEST(FrameBufferPoolTest, BuffersAreRecycled) {
+    AV::Utils::FrameBufferPool pool;
+
+    AVFrame *frame = av_frame_alloc();
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = 640;
+    frame->height = 360;
+
+    ASSERT_EQ(pool.GetBuffer(frame, frame->width, frame->height), 0);
+    uint8_t *first = frame->data[0];
+    EXPECT_EQ(frame->data[1], frame->data[0] + frame->linesize[0] * frame->height);
+    EXPECT_EQ(frame->data[2], frame->data[1] + frame->linesize[1] * frame->height / 2);
+
+    av_frame_unref(frame);
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = 640;
+    frame->height = 360;
+
+    ASSERT_EQ(pool.GetBuffer(frame, frame->width, frame->height), 0);
+    EXPECT_EQ(frame->data[0], first);
+
+    av_frame_free(&frame);
+}
+
+TEST(FrameBufferPoolTest, DecoderWritesIntoPool) {
+    auto [demuxer, demuxer_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4");
+    auto streams = demuxer->GetStreamPointers();
+
+    auto [decoder, decoder_err] = AV::Utils::Decoder::Create(streams[0]->codecpar);
+    ASSERT_EQ(decoder_err.code(), 0);
+
+    AVFrame *decoded = nullptr;
+    while (decoded == nullptr) {
+        auto [packet, packet_err] = demuxer->ReadFrame();
+        ASSERT_EQ(packet_err.code(), 0);
+        if (packet->stream_index != 0) {
+            continue;
+        }
+
+        EXPECT_EQ(decoder->FillDecoder(packet).code(), 0);
+
+        auto [frame, frame_err] = decoder->Decode();
+        if (frame_err.code() == 0) {
+            decoded = frame;
+        }
+    }
+
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(decoded->linesize[i] % AVUTILS_FRAME_ALIGN, 0);
+        EXPECT_EQ((uintptr_t)decoded->data[i] % AVUTILS_FRAME_ALIGN, 0u);
+    }
+
+    // Every plane sits in the one pooled buffer
+    EXPECT_EQ(decoded->buf[1], nullptr);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,69 @@
+/**
+ * @file frametimer_test.cpp
+ * @brief This file includes tests for the FrameTimer class.
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include <gtest/gtest.h>
+
+#include "frametimer.hpp"
+
+static AV::Utils::FramePtr MakeFrame(int64_t pts, AVRational time_base) {
+    AV::Utils::FramePtr frame(av_frame_alloc());
+    frame->pts = pts;
+    frame->time_base = time_base;
+    return frame;
+}
+
+TEST(FrameTimerTest, PopsInPresentationOrder) {
+    AV::Utils::FrameTimer timer;
+
+    // Out of order pts, video in 1/90000 and audio in 1/48000
+    const int64_t video_pts[] = {9000, 0, 3000, 6000};
+    const int64_t audio_pts[] = {2048, 0, 1024, 3072};
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(timer.AddFrame(MakeFrame(video_pts[i], {1, 90000})).code(), 0);
+        EXPECT_EQ(timer.AddFrame(MakeFrame(audio_pts[i], {1, 48000})).code(), 0);
+    }
+
+    int64_t last_us = INT64_MIN;
+    int count = 0;
+    while (!timer.IsEmpty()) {
+        AV::Utils::FramePtr frame = timer.GetFrame();
+        int64_t us = av_rescale_q(frame->pts, frame->time_base, {1, 1000000});
+        EXPECT_LE(last_us, us);
+
+        last_us = us;
+        count++;
+    }
+
+    EXPECT_EQ(count, 8);
+}
+
+TEST(FrameTimerTest, RejectsWhenFull) {
+    AV::Utils::FrameTimer timer(2);
+
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(timer.AddFrame(MakeFrame(i, {1, 25})).code(), 0);
+    }
+
+    EXPECT_TRUE(timer.IsFull());
+
+    // A rejected frame stays with the caller
+    AV::Utils::FramePtr frame = MakeFrame(2, {1, 25});
+    EXPECT_EQ(timer.AddFrame(std::move(frame)).code(), (int)AV::Utils::AvError::BUFFERFULL);
+    EXPECT_NE(frame, nullptr);
+}
+
+TEST(FrameTimerTest, RejectsFramesWithoutPts) {
+    AV::Utils::FrameTimer timer;
+
+    EXPECT_EQ(timer.AddFrame(MakeFrame(AV_NOPTS_VALUE, {1, 25})).code(), (int)AV::Utils::AvError::INVALIDFRAME);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,125 @@
+/**
+ * @file packetqueue_test.cpp
+ * @brief This file includes tests for the PacketQueue and PacketPool classes.
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include <gtest/gtest.h>
+
+#include "packetqueue.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Packet of size bytes lasting duration_ms
+static AVPacket *MakePacket(int size, int64_t duration_ms) {
+    AVPacket *packet = av_packet_alloc();
+    av_new_packet(packet, size);
+    packet->duration = duration_ms;
+    packet->time_base = {1, 1000};
+    return packet;
+}
+
+// Push on another thread and check it only gets through once a packet is popped
+static void ExpectFull(AV::Utils::PacketQueue &queue, AVPacket *packet) {
+    std::atomic<bool> pushed = false;
+    std::thread producer([&queue, &pushed, packet] {
+        EXPECT_TRUE(queue.Push(packet));
+        pushed = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(pushed.load());
+
+    AVPacket *popped = nullptr;
+    ASSERT_TRUE(queue.Pop(popped));
+    av_packet_free(&popped);
+
+    producer.join();
+    EXPECT_TRUE(pushed.load());
+}
+
+static void Drain(AV::Utils::PacketQueue &queue) {
+    AVPacket *packet = nullptr;
+    while (queue.TryPop(packet)) {
+        av_packet_free(&packet);
+    }
+}
+
+TEST(PacketQueueTest, BoundedByDuration) {
+    AV::Utils::PacketQueueConfig config;
+    config.max_duration_us = 100000;
+    AV::Utils::PacketQueue queue(config);
+
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(queue.Push(MakePacket(16, 40)));
+    }
+    EXPECT_EQ(queue.GetDurationUs(), 120000);
+
+    ExpectFull(queue, MakePacket(16, 40));
+    EXPECT_EQ(queue.Size(), 3u);
+
+    Drain(queue);
+    EXPECT_EQ(queue.GetDurationUs(), 0);
+    EXPECT_EQ(queue.GetBytes(), 0u);
+}
+
+TEST(PacketQueueTest, BoundedByBytes) {
+    AV::Utils::PacketQueueConfig config;
+    config.max_bytes = 1000;
+    AV::Utils::PacketQueue queue(config);
+
+    // An empty queue takes a packet larger than the bound
+    ASSERT_TRUE(queue.Push(MakePacket(4000, 0)));
+    EXPECT_EQ(queue.GetBytes(), 4000u);
+
+    ExpectFull(queue, MakePacket(10, 0));
+    EXPECT_EQ(queue.GetBytes(), 10u);
+
+    Drain(queue);
+}
+
+TEST(PacketQueueTest, NullPacketsAndClose) {
+    AV::Utils::PacketQueue queue;
+
+    ASSERT_TRUE(queue.Push(MakePacket(16, 40)));
+    ASSERT_TRUE(queue.Push(nullptr));
+    queue.Close();
+    EXPECT_FALSE(queue.Push(nullptr));
+
+    AVPacket *packet = nullptr;
+    ASSERT_TRUE(queue.Pop(packet));
+    ASSERT_NE(packet, nullptr);
+    av_packet_free(&packet);
+
+    ASSERT_TRUE(queue.Pop(packet));
+    EXPECT_EQ(packet, nullptr);
+
+    EXPECT_FALSE(queue.Pop(packet));
+    EXPECT_EQ(queue.GetDurationUs(), 0);
+}
+
+TEST(PacketPoolTest, RecyclesPackets) {
+    AV::Utils::PacketPool pool;
+    AVPacket *src = MakePacket(64, 40);
+    src->pts = 7;
+
+    AVPacket *packet = pool.Ref(src);
+    ASSERT_NE(packet, nullptr);
+    EXPECT_EQ(packet->data, src->data);
+    EXPECT_EQ(packet->pts, 7);
+
+    AVPacket *recycled = packet;
+    pool.Release(packet);
+    EXPECT_EQ(packet, nullptr);
+
+    // The struct comes back, referencing the new payload
+    packet = pool.Ref(src);
+    EXPECT_EQ(packet, recycled);
+    EXPECT_EQ(packet->data, src->data);
+
+    pool.Release(packet);
+    av_packet_free(&src);
+}
@@ -10,6 +10,9 @@
 #include "decoder.hpp"
 #include "demuxer.hpp"
 #include "pixelencoder.hpp"
+#include "framepool.hpp"
+
+#include <cstring>
 
 TEST(PixelEncoderTest, CreatePixelEncoderSimple) {
     AV::Utils::PixelEncoderConfig config;
@@ -71,6 +74,103 @@ TEST(PixelEncoderTest, EncodeMultipleFrames) {
     }
 }
 
+TEST(PixelEncoderTest, BandedMatchesSinglePass) {
+    auto [demuxer, demuxer_err] = AV::Utils::Demuxer::Create("testcontent/rickroll.mp4");
+    auto streams = demuxer->GetStreamPointers();
+
+    AVCodecParameters *codecpar = streams[0]->codecpar;
+
+    auto [decoder, decoder_err] = AV::Utils::Decoder::Create(codecpar);
+
+    AV::Utils::PixelEncoderConfig config;
+    config.src_width = codecpar->width;
+    config.src_height = codecpar->height;
+    config.src_pix_fmt = (AVPixelFormat)codecpar->format;
+    config.dst_width = 3840;
+    config.dst_height = 2160;
+    config.dst_pix_fmt = AV_PIX_FMT_UYVY422;
+
+    auto [single, single_err] = AV::Utils::PixelEncoder::Create(config);
+    ASSERT_EQ(single_err.code(), 0);
+
+    config.thread_pool = std::make_shared<AV::Utils::ThreadPool>(4);
+    auto [banded, banded_err] = AV::Utils::PixelEncoder::Create(config);
+    ASSERT_EQ(banded_err.code(), 0);
+
+    AVFrame *frame = nullptr;
+    while (frame == nullptr) {
+        auto [packet, packet_err] = demuxer->ReadFrame();
+        ASSERT_EQ(packet_err.code(), 0);
+        if (packet->stream_index != 0) {
+            continue;
+        }
+
+        decoder->FillDecoder(packet);
+        auto [decoded_frame, decoded_frame_err] = decoder->Decode();
+        if (decoded_frame_err.code() == 0) {
+            frame = decoded_frame;
+        }
+    }
+
+    auto [single_frame, single_frame_err] = single->Encode(frame);
+    auto [banded_frame, banded_frame_err] = banded->Encode(frame);
+    ASSERT_EQ(single_frame_err.code(), 0);
+    ASSERT_EQ(banded_frame_err.code(), 0);
+
+    for (int row = 0; row < 2160; row++) {
+        ASSERT_EQ(memcmp(single_frame->data[0] + row * single_frame->linesize[0],
+                         banded_frame->data[0] + row * banded_frame->linesize[0], 3840 * 2), 0) << "row " << row;
+    }
+}
+
+TEST(PixelEncoderTest, EncodeIntoOwnedFrames) {
+    AV::Utils::PixelEncoderConfig config;
+    config.src_width = 1920;
+    config.src_height = 1080;
+    config.src_pix_fmt = AV_PIX_FMT_UYVY422;
+    config.dst_width = 960;
+    config.dst_height = 540;
+    config.dst_pix_fmt = AV_PIX_FMT_UYVY422;
+
+    auto [encoder, encoder_err] = AV::Utils::PixelEncoder::Create(config);
+    ASSERT_EQ(encoder_err.code(), 0);
+
+    AVFrame *frame = av_frame_alloc();
+    frame->width = 1920;
+    frame->height = 1080;
+    frame->format = AV_PIX_FMT_UYVY422;
+    ASSERT_GE(av_frame_get_buffer(frame, 0), 0);
+
+    AV::Utils::FrameBufferPool pool;
+    AVFrame *outputs[2] = {};
+    for (int i = 0; i < 2; i++) {
+        // A flat grey that changes per frame, scaling keeps it as is
+        for (int row = 0; row < frame->height; row++) {
+            memset(frame->data[0] + row * frame->linesize[0], 0x40 + i, frame->width * 2);
+        }
+        frame->pts = i;
+
+        outputs[i] = av_frame_alloc();
+        outputs[i]->width = 960;
+        outputs[i]->height = 540;
+        outputs[i]->format = AV_PIX_FMT_UYVY422;
+        ASSERT_EQ(pool.GetBuffer(outputs[i], 960, 540), 0);
+
+        auto err = encoder->EncodeInto(frame, outputs[i]);
+        ASSERT_EQ(err.code(), 0);
+    }
+
+    // The first output is untouched by the second encode
+    for (int i = 0; i < 2; i++) {
+        EXPECT_EQ(outputs[i]->pts, i);
+        EXPECT_EQ(outputs[i]->data[0][0], 0x40 + i);
+        EXPECT_EQ(outputs[i]->data[0][outputs[i]->linesize[0] * 539 + 960 * 2 - 1], 0x40 + i);
+        av_frame_free(&outputs[i]);
+    }
+
+    av_frame_free(&frame);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
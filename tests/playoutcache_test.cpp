@@ -0,0 +1,230 @@
+/**
+ * @file playoutcache_test.cpp
+ * @brief This file includes tests for the PlayoutCache and PlayoutCacheWriter classes.
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include <gtest/gtest.h>
+
+#include "playoutcache.hpp"
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static std::string CachePath(const char *name) {
+    return "/tmp/" + std::string(name) + "." + std::to_string(getpid()) + ".ndicache";
+}
+
+static AV::Utils::PlayoutCacheFormat MakeFormat() {
+    AV::Utils::PlayoutCacheFormat format{};
+    format.width = 8;
+    format.height = 4;
+    format.frame_rate = {25, 1};
+    format.sample_rate = 48000;
+    format.channels = 2;
+    return format;
+}
+
+// UYVY frame whose bytes are index + offset within the frame, rows padded past the width
+static AVFrame MakeVideo(std::vector<uint8_t> &data, int index) {
+    const int linesize = 32;
+    data.assign(linesize * 4, 0);
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 16; x++) {
+            data[y * linesize + x] = (uint8_t)(index + y * 16 + x);
+        }
+    }
+
+    AVFrame frame{};
+    frame.format = AV_PIX_FMT_UYVY422;
+    frame.width = 8;
+    frame.height = 4;
+    frame.data[0] = data.data();
+    frame.linesize[0] = linesize;
+    return frame;
+}
+
+// extended_data points into the frame itself, so it is filled in place
+static void FillAudio(AVFrame &frame, std::vector<float> &left, std::vector<float> &right, int samples, float value) {
+    left.assign(samples, value);
+    right.assign(samples, -value);
+
+    frame = AVFrame{};
+    frame.format = AV_SAMPLE_FMT_FLTP;
+    frame.sample_rate = 48000;
+    frame.nb_samples = samples;
+    frame.ch_layout.nb_channels = 2;
+    frame.data[0] = (uint8_t *)left.data();
+    frame.data[1] = (uint8_t *)right.data();
+    frame.extended_data = frame.data;
+}
+
+TEST(PlayoutCacheTest, RoundTrip) {
+    const std::string path = CachePath("roundtrip");
+
+    {
+        auto [writer, err] = AV::Utils::PlayoutCacheWriter::Create(path, MakeFormat());
+        ASSERT_EQ(err.code(), 0);
+
+        std::vector<uint8_t> video;
+        std::vector<float> left, right;
+        for (int i = 0; i < 3; i++) {
+            AVFrame video_frame = MakeVideo(video, i);
+            ASSERT_EQ(writer->AddVideo(&video_frame).code(), 0);
+        }
+
+        // The second record has no audio
+        AVFrame audio_frame;
+        FillAudio(audio_frame, left, right, 1920, 0.5f);
+        ASSERT_EQ(writer->AddAudio(&audio_frame).code(), 0);
+        FillAudio(audio_frame, left, right, 0, 0.0f);
+        ASSERT_EQ(writer->AddAudio(&audio_frame).code(), 0);
+        FillAudio(audio_frame, left, right, 100, 0.25f);
+        ASSERT_EQ(writer->AddAudio(&audio_frame).code(), 0);
+
+        // Longer than a frame period
+        FillAudio(audio_frame, left, right, 1921, 0.0f);
+        EXPECT_NE(writer->AddAudio(&audio_frame).code(), 0);
+
+        ASSERT_EQ(writer->Finish().code(), 0);
+    }
+
+    auto [cache, err] = AV::Utils::PlayoutCache::Open(path);
+    ASSERT_EQ(err.code(), 0);
+    ASSERT_EQ(cache->GetFrameCount(), 3);
+    EXPECT_EQ(cache->GetFrameRate().num, 25);
+    EXPECT_EQ(cache->GetAudioStart(), 0);
+    EXPECT_EQ(cache->GetAudioChunkCount(), 3);
+
+    for (int i = 0; i < 3; i++) {
+        AV::Utils::FramePtr frame = cache->GetVideoFrame(i);
+        ASSERT_NE(frame, nullptr);
+        EXPECT_EQ(frame->width, 8);
+        EXPECT_EQ(frame->height, 4);
+        EXPECT_EQ(frame->linesize[0] % 64, 0);
+        for (int y = 0; y < 4; y++) {
+            for (int x = 0; x < 16; x++) {
+                ASSERT_EQ(frame->data[0][y * frame->linesize[0] + x], (uint8_t)(i + y * 16 + x));
+            }
+        }
+    }
+    EXPECT_EQ(cache->GetVideoFrame(3), nullptr);
+
+    AV::Utils::FramePtr audio = cache->GetAudioFrame(0);
+    ASSERT_NE(audio, nullptr);
+    EXPECT_EQ(audio->nb_samples, 1920);
+    EXPECT_EQ(((float *)audio->extended_data[0])[1919], 0.5f);
+    EXPECT_EQ(((float *)audio->extended_data[1])[0], -0.5f);
+
+    EXPECT_EQ(cache->GetAudioFrame(1), nullptr);
+
+    audio = cache->GetAudioFrame(2);
+    ASSERT_NE(audio, nullptr);
+    EXPECT_EQ(audio->nb_samples, 100);
+    EXPECT_EQ(((float *)audio->extended_data[1])[99], -0.25f);
+
+    remove(path.c_str());
+}
+
+TEST(PlayoutCacheTest, AudioStartOffset) {
+    const std::string path = CachePath("offset");
+
+    {
+        auto [writer, err] = AV::Utils::PlayoutCacheWriter::Create(path, MakeFormat());
+        ASSERT_EQ(err.code(), 0);
+
+        // Video starts at 0.4 s, audio 0.1 s ahead of it and the audio is recorded first
+        std::vector<float> left, right;
+        AVFrame audio_frame;
+        for (int i = 0; i < 6; i++) {
+            FillAudio(audio_frame, left, right, 1920, (float)i);
+            audio_frame.pts = 14400 + 1920 * i;
+            audio_frame.time_base = {1, 48000};
+            ASSERT_EQ(writer->AddAudio(&audio_frame).code(), 0);
+        }
+
+        std::vector<uint8_t> video;
+        for (int i = 0; i < 2; i++) {
+            AVFrame video_frame = MakeVideo(video, i);
+            video_frame.pts = 10 + i;
+            video_frame.time_base = {1, 25};
+            ASSERT_EQ(writer->AddVideo(&video_frame).code(), 0);
+        }
+
+        ASSERT_EQ(writer->Finish().code(), 0);
+    }
+
+    auto [cache, err] = AV::Utils::PlayoutCache::Open(path);
+    ASSERT_EQ(err.code(), 0);
+    EXPECT_EQ(cache->GetAudioStart(), -4800);
+    EXPECT_EQ(cache->GetFrameCount(), 2);
+
+    // 4800 samples lead in and two frames of 1920 need five chunks, the sixth starts after the last frame
+    ASSERT_EQ(cache->GetAudioChunkCount(), 5);
+    for (int i = 0; i < 5; i++) {
+        AV::Utils::FramePtr audio = cache->GetAudioFrame(i);
+        ASSERT_NE(audio, nullptr);
+        EXPECT_EQ(audio->nb_samples, 1920);
+        EXPECT_EQ(((float *)audio->extended_data[0])[0], (float)i);
+    }
+    EXPECT_EQ(cache->GetAudioFrame(5), nullptr);
+    EXPECT_EQ(cache->GetVideoFrame(2), nullptr);
+
+    remove(path.c_str());
+}
+
+TEST(PlayoutCacheTest, FramesOutliveCache) {
+    const std::string path = CachePath("outlive");
+
+    {
+        auto [writer, err] = AV::Utils::PlayoutCacheWriter::Create(path, MakeFormat());
+        ASSERT_EQ(err.code(), 0);
+
+        std::vector<uint8_t> video;
+        AVFrame video_frame = MakeVideo(video, 7);
+        ASSERT_EQ(writer->AddVideo(&video_frame).code(), 0);
+        ASSERT_EQ(writer->Finish().code(), 0);
+    }
+
+    AV::Utils::FramePtr first, second;
+    {
+        auto [cache, err] = AV::Utils::PlayoutCache::Open(path);
+        ASSERT_EQ(err.code(), 0);
+
+        first = cache->GetVideoFrame(0);
+        second = cache->GetVideoFrame(0);
+    }
+
+    // Both frames point into the one mapping, which stays alive with them
+    ASSERT_NE(first, nullptr);
+    EXPECT_EQ(first->data[0], second->data[0]);
+    EXPECT_EQ(first->data[0][0], 7);
+
+    remove(path.c_str());
+}
+
+TEST(PlayoutCacheTest, UnfinishedLeavesNothing) {
+    const std::string path = CachePath("unfinished");
+
+    {
+        auto [writer, err] = AV::Utils::PlayoutCacheWriter::Create(path, MakeFormat());
+        ASSERT_EQ(err.code(), 0);
+
+        std::vector<uint8_t> video;
+        AVFrame video_frame = MakeVideo(video, 0);
+        ASSERT_EQ(writer->AddVideo(&video_frame).code(), 0);
+
+        // Wrong size
+        video_frame.width = 16;
+        EXPECT_NE(writer->AddVideo(&video_frame).code(), 0);
+    }
+
+    EXPECT_NE(access(path.c_str(), F_OK), 0);
+
+    auto [cache, err] = AV::Utils::PlayoutCache::Open(path);
+    EXPECT_EQ(cache, nullptr);
+    EXPECT_NE(err.code(), 0);
+}
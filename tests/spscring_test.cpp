@@ -0,0 +1,87 @@
+/**
+ * @file spscring_test.cpp
+ * @brief This file includes tests for the SPSCRing class.
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "spscring.hpp"
+
+TEST(SPSCRingTest, PushPopSingleThread) {
+    AV::Utils::SPSCRing<int, 4> ring;
+
+    for (int i = 0; i < 4; i++) {
+        EXPECT_TRUE(ring.TryPush(i));
+    }
+
+    int extra = 4;
+    EXPECT_FALSE(ring.TryPush(extra));
+    EXPECT_EQ(ring.Size(), 4);
+
+    for (int i = 0; i < 4; i++) {
+        int value = -1;
+        EXPECT_TRUE(ring.TryPop(value));
+        EXPECT_EQ(value, i);
+    }
+
+    int value = -1;
+    EXPECT_FALSE(ring.TryPop(value));
+    EXPECT_TRUE(ring.IsEmpty());
+}
+
+TEST(SPSCRingTest, BlockingProducerConsumer) {
+    AV::Utils::SPSCRing<int, 8> ring;
+    const int count = 100000;
+
+    std::thread producer([&ring, count] {
+        for (int i = 0; i < count; i++) {
+            int value = i;
+            ring.Push(value);
+        }
+
+        ring.Close();
+    });
+
+    int expected = 0;
+    int value = -1;
+    while (ring.Pop(value)) {
+        EXPECT_EQ(value, expected);
+        expected++;
+    }
+
+    producer.join();
+    EXPECT_EQ(expected, count);
+}
+
+TEST(SPSCRingTest, CloseWakesBlockedProducer) {
+    AV::Utils::SPSCRing<int, 2> ring;
+
+    int a = 1, b = 2;
+    ring.Push(a);
+    ring.Push(b);
+
+    std::thread producer([&ring] {
+        int c = 3;
+        EXPECT_FALSE(ring.Push(c));
+    });
+
+    ring.Close();
+    producer.join();
+
+    // Items pushed before the close are still delivered
+    int value = -1;
+    EXPECT_TRUE(ring.Pop(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(ring.Pop(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_FALSE(ring.Pop(value));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
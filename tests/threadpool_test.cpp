@@ -0,0 +1,107 @@
+/**
+ * @file threadpool_test.cpp
+ * @brief This file includes tests for the ThreadPool class.
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include <gtest/gtest.h>
+
+#include "threadpool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+TEST(ThreadPoolTest, RunsEveryIterationOnce) {
+    AV::Utils::ThreadPool pool(4);
+    EXPECT_EQ(pool.GetThreadCount(), 4u);
+
+    std::vector<std::atomic<int>> hits(1000);
+    pool.ParallelFor(hits.size(), [&hits](size_t i) { hits[i]++; });
+
+    for (auto &hit : hits) {
+        EXPECT_EQ(hit.load(), 1);
+    }
+}
+
+TEST(ThreadPoolTest, SingleThreadRunsInline) {
+    AV::Utils::ThreadPool pool(1);
+
+    std::thread::id caller = std::this_thread::get_id();
+    pool.ParallelFor(16, [caller](size_t) { EXPECT_EQ(std::this_thread::get_id(), caller); });
+}
+
+TEST(ThreadPoolTest, ConcurrentCallers) {
+    AV::Utils::ThreadPool pool(3);
+
+    std::atomic<size_t> total = 0;
+    std::vector<std::thread> callers;
+    for (int c = 0; c < 4; c++) {
+        callers.emplace_back([&pool, &total] {
+            for (int round = 0; round < 200; round++) {
+                pool.ParallelFor(17, [&total](size_t i) { total += i; });
+            }
+        });
+    }
+
+    for (auto &caller : callers) {
+        caller.join();
+    }
+
+    // 4 callers, 200 rounds, sum of 0..16
+    EXPECT_EQ(total.load(), 4u * 200u * 136u);
+}
+
+TEST(ThreadPoolTest, WorkersMoveToHigherPriority) {
+    AV::Utils::ThreadPool pool(2);
+
+    // Workers seen inside the low priority loop
+    std::mutex low_workers_mutex;
+    std::set<std::thread::id> low_workers;
+    std::atomic<bool> worker_in_low = false;
+
+    std::thread low([&pool, &low_workers_mutex, &low_workers, &worker_in_low] {
+        AV::Utils::ThreadPool::SetPriority(0);
+
+        std::thread::id low_caller = std::this_thread::get_id();
+        pool.ParallelFor(400, [low_caller, &low_workers_mutex, &low_workers, &worker_in_low](size_t) {
+            if (std::this_thread::get_id() != low_caller) {
+                std::lock_guard<std::mutex> lock(low_workers_mutex);
+                low_workers.insert(std::this_thread::get_id());
+                worker_in_low = true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        });
+    });
+
+    // Only queue the high priority loop once the worker is busy on the low one
+    while (!worker_in_low) {
+        std::this_thread::yield();
+    }
+
+    // The only worker has to leave the low priority loop to help here
+    AV::Utils::ThreadPool::SetPriority(10);
+
+    std::thread::id caller = std::this_thread::get_id();
+    std::mutex helpers_mutex;
+    std::set<std::thread::id> helpers;
+    pool.ParallelFor(100, [caller, &helpers_mutex, &helpers](size_t) {
+        if (std::this_thread::get_id() != caller) {
+            std::lock_guard<std::mutex> lock(helpers_mutex);
+            helpers.insert(std::this_thread::get_id());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+
+    AV::Utils::ThreadPool::SetPriority(0);
+    low.join();
+
+    // The helper is the worker that was inside the low priority loop
+    ASSERT_EQ(low_workers.size(), 1u);
+    ASSERT_EQ(helpers.size(), 1u);
+    EXPECT_EQ(*helpers.begin(), *low_workers.begin());
+}
@@ -0,0 +1,313 @@
+/**
+ * @file uyvyconverter_test.cpp
+ * @brief This file includes golden output tests for the UYVYConverter class.
+ * @date 2026-10-16
+ * @author Matthew Todd Geiger
+ */
+
+#include <gtest/gtest.h>
+
+#include "uyvyconverter.hpp"
+#include "simplefilter.hpp"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+static const AV::Utils::UYVYKernel kKernels[] = {
+    AV::Utils::UYVYKernel::SCALAR,
+    AV::Utils::UYVYKernel::SSE41,
+    AV::Utils::UYVYKernel::AVX2,
+    AV::Utils::UYVYKernel::AVX512,
+};
+
+static AVFrame *MakeNoiseFrame(AVPixelFormat pix_fmt, int width, int height) {
+    AVFrame *frame = av_frame_alloc();
+    frame->format = pix_fmt;
+    frame->width = width;
+    frame->height = height;
+    av_frame_get_buffer(frame, 0);
+
+    std::mt19937 rng(width * 31 + height);
+    for (int plane = 0; plane < 4 && frame->buf[plane]; plane++) {
+        for (size_t i = 0; i < frame->buf[plane]->size; i++) {
+            frame->buf[plane]->data[i] = (uint8_t)rng();
+        }
+    }
+
+    return frame;
+}
+
+// swscale has no dedicated NV12 to UYVY path, so the golden frame comes from the equivalent YUV420P frame
+static AVFrame *DeinterleaveNV12(const AVFrame *nv12) {
+    AVFrame *frame = av_frame_alloc();
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width = nv12->width;
+    frame->height = nv12->height;
+    av_frame_get_buffer(frame, 0);
+
+    av_image_copy_plane(frame->data[0], frame->linesize[0], nv12->data[0], nv12->linesize[0], nv12->width, nv12->height);
+    for (int row = 0; row < (nv12->height + 1) / 2; row++) {
+        const uint8_t *uv = nv12->data[1] + row * nv12->linesize[1];
+        for (int x = 0; x < (nv12->width + 1) / 2; x++) {
+            frame->data[1][row * frame->linesize[1] + x] = uv[x * 2];
+            frame->data[2][row * frame->linesize[2] + x] = uv[x * 2 + 1];
+        }
+    }
+
+    return frame;
+}
+
+static AVFrame *SwscaleUYVY(const AVFrame *src) {
+    AVFrame *frame = av_frame_alloc();
+    frame->format = AV_PIX_FMT_UYVY422;
+    frame->width = src->width;
+    frame->height = src->height;
+    av_frame_get_buffer(frame, 0);
+
+    SwsContext *sws_ctx = sws_getContext(src->width, src->height, (AVPixelFormat)src->format,
+                                         src->width, src->height, AV_PIX_FMT_UYVY422,
+                                         SWS_POINT, nullptr, nullptr, nullptr);
+    sws_scale(sws_ctx, src->data, src->linesize, 0, src->height, frame->data, frame->linesize);
+    sws_freeContext(sws_ctx);
+
+    return frame;
+}
+
+static void ExpectGolden(AVPixelFormat pix_fmt, int width, int height) {
+    AVFrame *src = MakeNoiseFrame(pix_fmt, width, height);
+
+    AVFrame *golden_src = pix_fmt == AV_PIX_FMT_NV12 ? DeinterleaveNV12(src) : src;
+    AVFrame *golden = SwscaleUYVY(golden_src);
+
+    for (auto kernel : kKernels) {
+        if (!AV::Utils::UYVYConverter::IsKernelSupported(kernel)) {
+            continue;
+        }
+
+        AV::Utils::UYVYConverterConfig config{};
+        config.width = width;
+        config.height = height;
+        config.src_pix_fmt = pix_fmt;
+        config.kernel = kernel;
+
+        auto [converter, converter_err] = AV::Utils::UYVYConverter::Create(config);
+        ASSERT_EQ(converter_err.code(), 0);
+
+        auto [uyvy, uyvy_err] = converter->Convert(src);
+        ASSERT_EQ(uyvy_err.code(), 0);
+        EXPECT_EQ(uyvy->format, AV_PIX_FMT_UYVY422);
+
+        for (int row = 0; row < height; row++) {
+            ASSERT_EQ(memcmp(uyvy->data[0] + row * uyvy->linesize[0], golden->data[0] + row * golden->linesize[0], width * 2), 0)
+                << "kernel " << (int)kernel << " row " << row;
+        }
+
+        av_frame_free(&uyvy);
+    }
+
+    if (golden_src != src) {
+        av_frame_free(&golden_src);
+    }
+
+    av_frame_free(&golden);
+    av_frame_free(&src);
+}
+
+TEST(UYVYConverterTest, YUV420PMatchesSwscale) {
+    ExpectGolden(AV_PIX_FMT_YUV420P, 1920, 1080);
+    ExpectGolden(AV_PIX_FMT_YUV420P, 718, 478);
+}
+
+TEST(UYVYConverterTest, YUV422PMatchesSwscale) {
+    ExpectGolden(AV_PIX_FMT_YUV422P, 1920, 1080);
+    ExpectGolden(AV_PIX_FMT_YUV422P, 718, 478);
+}
+
+TEST(UYVYConverterTest, NV12MatchesSwscale) {
+    ExpectGolden(AV_PIX_FMT_NV12, 1920, 1080);
+    ExpectGolden(AV_PIX_FMT_NV12, 718, 478);
+}
+
+// Full range black to white ramp with the chroma at the ends of its range
+static AVFrame *MakeFullRangeFrame(AVPixelFormat pix_fmt, int width, int height) {
+    AVFrame *frame = av_frame_alloc();
+    frame->format = pix_fmt;
+    frame->width = width;
+    frame->height = height;
+    frame->color_range = AVCOL_RANGE_JPEG;
+    av_frame_get_buffer(frame, 0);
+
+    const int chroma_height = pix_fmt == AV_PIX_FMT_YUVJ420P ? (height + 1) / 2 : height;
+    for (int row = 0; row < height; row++) {
+        for (int x = 0; x < width; x++) {
+            frame->data[0][row * frame->linesize[0] + x] = (uint8_t)(x * 255 / (width - 1));
+        }
+    }
+
+    for (int row = 0; row < chroma_height; row++) {
+        memset(frame->data[1] + row * frame->linesize[1], 0, (width + 1) / 2);
+        memset(frame->data[2] + row * frame->linesize[2], 255, (width + 1) / 2);
+    }
+
+    return frame;
+}
+
+static void ExpectFullRangeGolden(AVPixelFormat pix_fmt, int width, int height) {
+    // Packing full range samples as is would crush blacks and clip whites
+    EXPECT_FALSE(AV::Utils::UYVYConverter::IsSupported(pix_fmt));
+
+    AVFrame *src = MakeFullRangeFrame(pix_fmt, width, height);
+    AVFrame *golden = SwscaleUYVY(src);
+
+    // The fallback the pipeline takes for these frames
+    AVCodecParameters *codecpar = avcodec_parameters_alloc();
+    codecpar->width = width;
+    codecpar->height = height;
+    codecpar->format = pix_fmt;
+    codecpar->sample_aspect_ratio = {1, 1};
+
+    auto [filter, filter_err] = AV::Utils::SimpleFilter::CreateFilter("format=uyvy422", codecpar, {1, 25});
+    avcodec_parameters_free(&codecpar);
+    ASSERT_EQ(filter_err.code(), 0);
+
+    AVFrame *input = av_frame_clone(src);
+    ASSERT_EQ(filter->FillFilter(AV::Utils::FramePtr(input)).code(), 0);
+
+    auto [uyvy, uyvy_err] = filter->FilterFrame();
+    ASSERT_EQ(uyvy_err.code(), 0);
+    ASSERT_EQ(uyvy->format, AV_PIX_FMT_UYVY422);
+
+    for (int row = 0; row < height; row++) {
+        const uint8_t *line = uyvy->data[0] + row * uyvy->linesize[0];
+        const uint8_t *golden_line = golden->data[0] + row * golden->linesize[0];
+
+        // Rounding of the range scaling may differ by one between swscale's paths
+        for (int i = 0; i < width * 2; i++) {
+            ASSERT_LE(abs(line[i] - golden_line[i]), 1) << "row " << row << " byte " << i;
+        }
+
+        // Limited range: luma 16-235, chroma 16-240
+        EXPECT_NEAR(line[0], 16, 1);
+        EXPECT_NEAR(line[1], 16, 1);
+        EXPECT_NEAR(line[2], 240, 1);
+        EXPECT_NEAR(line[width * 2 - 1], 235, 1);
+    }
+
+    av_frame_free(&golden);
+    av_frame_free(&src);
+}
+
+TEST(UYVYConverterTest, FullRangeMatchesSwscale) {
+    ExpectFullRangeGolden(AV_PIX_FMT_YUVJ420P, 1920, 1080);
+    ExpectFullRangeGolden(AV_PIX_FMT_YUVJ422P, 718, 478);
+}
+
+TEST(UYVYConverterTest, BandedMatchesSinglePass) {
+    AVFrame *src = MakeNoiseFrame(AV_PIX_FMT_YUV420P, 3840, 2160);
+
+    AV::Utils::UYVYConverterConfig config{};
+    config.width = 3840;
+    config.height = 2160;
+    config.src_pix_fmt = AV_PIX_FMT_YUV420P;
+
+    auto [single, single_err] = AV::Utils::UYVYConverter::Create(config);
+    ASSERT_EQ(single_err.code(), 0);
+
+    config.thread_pool = std::make_shared<AV::Utils::ThreadPool>(4);
+    auto [banded, banded_err] = AV::Utils::UYVYConverter::Create(config);
+    ASSERT_EQ(banded_err.code(), 0);
+
+    auto [single_frame, single_frame_err] = single->Convert(src);
+    auto [banded_frame, banded_frame_err] = banded->Convert(src);
+    ASSERT_EQ(single_frame_err.code(), 0);
+    ASSERT_EQ(banded_frame_err.code(), 0);
+
+    EXPECT_EQ(memcmp(single_frame->data[0], banded_frame->data[0], single_frame->linesize[0] * 2160), 0);
+
+    av_frame_free(&single_frame);
+    av_frame_free(&banded_frame);
+    av_frame_free(&src);
+}
+
+TEST(UYVYConverterTest, RejectsUnsupportedFormat) {
+    AV::Utils::UYVYConverterConfig config{};
+    config.width = 1920;
+    config.height = 1080;
+    config.src_pix_fmt = AV_PIX_FMT_RGB24;
+
+    auto [converter, converter_err] = AV::Utils::UYVYConverter::Create(config);
+    EXPECT_EQ(converter, nullptr);
+    EXPECT_EQ(converter_err.code(), (int)AV::Utils::AvError::UNSUPPORTEDPIXFMT);
+}
+
+// Time the converter against the format=uyvy422 filter graph the pipeline used before it
+static void ReportThroughput(AVPixelFormat pix_fmt, int width, int height, int iterations) {
+    using Clock = std::chrono::steady_clock;
+
+    AVFrame *src = MakeNoiseFrame(pix_fmt, width, height);
+
+    AV::Utils::UYVYConverterConfig config{};
+    config.width = width;
+    config.height = height;
+    config.src_pix_fmt = pix_fmt;
+
+    auto [converter, converter_err] = AV::Utils::UYVYConverter::Create(config);
+    ASSERT_EQ(converter_err.code(), 0);
+
+    AVCodecParameters *codecpar = avcodec_parameters_alloc();
+    codecpar->width = width;
+    codecpar->height = height;
+    codecpar->format = pix_fmt;
+    codecpar->sample_aspect_ratio = {1, 1};
+
+    auto [filter, filter_err] = AV::Utils::SimpleFilter::CreateFilter("format=uyvy422", codecpar, {1, 25});
+    avcodec_parameters_free(&codecpar);
+    ASSERT_EQ(filter_err.code(), 0);
+
+    auto converter_begin = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        auto [uyvy, uyvy_err] = converter->Convert(src);
+        ASSERT_EQ(uyvy_err.code(), 0);
+        av_frame_free(&uyvy);
+    }
+    auto converter_time = std::chrono::duration<double, std::milli>(Clock::now() - converter_begin).count() / iterations;
+
+    auto filter_begin = Clock::now();
+    for (int i = 0; i < iterations; i++) {
+        AVFrame *input = av_frame_clone(src);
+        input->pts = i;
+        ASSERT_EQ(filter->FillFilter(AV::Utils::FramePtr(input)).code(), 0);
+
+        auto [uyvy, uyvy_err] = filter->FilterFrame();
+        ASSERT_EQ(uyvy_err.code(), 0);
+        av_frame_free(&uyvy);
+    }
+    auto filter_time = std::chrono::duration<double, std::milli>(Clock::now() - filter_begin).count() / iterations;
+
+    // Wall clock only means something in an optimized build outside valgrind, so this reports instead of asserting
+    printf("%s %dx%d: converter %.3f ms/frame | filter graph %.3f ms/frame | %.2fx\n", av_get_pix_fmt_name(pix_fmt), width, height,
+           converter_time, filter_time, filter_time / converter_time);
+
+    std::string name = av_get_pix_fmt_name(pix_fmt);
+    ::testing::Test::RecordProperty(name + "_converter_us", (int)(converter_time * 1000));
+    ::testing::Test::RecordProperty(name + "_filter_us", (int)(filter_time * 1000));
+
+    av_frame_free(&src);
+}
+
+TEST(UYVYConverterTest, ThroughputAgainstFilterGraph) {
+    ReportThroughput(AV_PIX_FMT_YUV420P, 1920, 1080, 20);
+    ReportThroughput(AV_PIX_FMT_NV12, 1920, 1080, 20);
+    ReportThroughput(AV_PIX_FMT_YUV422P, 1920, 1080, 20);
+}